@@ -15,6 +15,8 @@
 #ifndef RMW_FASTRTPS_CPP__GET_CLIENT_HPP_
 #define RMW_FASTRTPS_CPP__GET_CLIENT_HPP_
 
+#include <cstdint>
+
 #include "fastrtps/publisher/Publisher.h"
 #include "fastrtps/subscriber/Subscriber.h"
 #include "rmw/rmw.h"
@@ -45,6 +47,62 @@ RMW_FASTRTPS_CPP_PUBLIC
 eprosima::fastrtps::Subscriber *
 get_response_subscriber(rmw_client_t * client);
 
+/// Return the number of responses dropped because too many were waiting to be taken.
+/**
+ * With a KEEP_LAST history QoS, a client queues at most `depth` responses and
+ * drops the oldest one to make room for a new one.
+ * With KEEP_ALL, none is dropped.
+ *
+ * The function returns `0` when either the client handle is `NULL` or
+ * when the client handle is from a different rmw implementation.
+ *
+ * \return number of dropped responses
+ */
+RMW_FASTRTPS_CPP_PUBLIC
+uint64_t
+get_dropped_response_count(rmw_client_t * client);
+
+/// Set the function called from the middleware thread when the client receives a response.
+/**
+ * The callback gets `user_data` and the number of responses received, it
+ * is called right away for the responses already waiting.
+ * The responses are not taken, the callback is expected to hand them over
+ * to an executor which takes them with rmw_take_response().
+ * Once this returns, the previous callback is not running and not called anymore,
+ * unless this is called from that callback itself.
+ * The callback runs without any lock held, it may call this or take responses.
+ * Passing a `nullptr` callback stops the notifications.
+ *
+ * \return `RMW_RET_OK` if successful, or
+ * \return `RMW_RET_INVALID_ARGUMENT` if the client handle is `NULL`, or
+ * \return `RMW_RET_ERROR` if the client handle is from a different rmw implementation
+ */
+RMW_FASTRTPS_CPP_PUBLIC
+rmw_ret_t
+set_on_new_response_callback(
+  rmw_client_t * client,
+  void (* callback)(const void * user_data, size_t number_of_responses),
+  const void * user_data);
+
+/// Take the response to the request sent with `sequence_id`, if it was received.
+/**
+ * Unlike rmw_take_response(), which takes the oldest response, the responses
+ * received before the requested one are kept for later takes.
+ *
+ * \param[in] sequence_id sequence id returned by rmw_send_request() for the request
+ * \param[out] taken whether the response was taken
+ * \return `RMW_RET_OK` if successful, even if the response was not received yet, or
+ * \return `RMW_RET_ERROR` if the client handle is from a different rmw implementation
+ */
+RMW_FASTRTPS_CPP_PUBLIC
+rmw_ret_t
+take_response_for(
+  const rmw_client_t * client,
+  int64_t sequence_id,
+  rmw_request_id_t * request_header,
+  void * ros_response,
+  bool * taken);
+
 }  // namespace rmw_fastrtps_cpp
 
 #endif  // RMW_FASTRTPS_CPP__GET_CLIENT_HPP_
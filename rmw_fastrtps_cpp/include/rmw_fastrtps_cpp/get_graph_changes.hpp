@@ -0,0 +1,78 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_CPP__GET_GRAPH_CHANGES_HPP_
+#define RMW_FASTRTPS_CPP__GET_GRAPH_CHANGES_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "rmw/rmw.h"
+#include "rmw_fastrtps_shared_cpp/graph_change_journal.hpp"
+#include "rmw_fastrtps_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_cpp
+{
+
+/// Return the endpoints discovered or removed since a previous call.
+/**
+ * Each change has a sequence number, the first one is 1.
+ * Passing the sequence of the last change already applied gives the ones
+ * following it, oldest first, so that a mirror of the graph only processes
+ * what changed after each trigger of the graph guard condition.
+ *
+ * Only the most recent changes are kept. If some of the requested ones were
+ * dropped, `resync_needed` is set to true and `changes` is left untouched;
+ * get_graph_endpoints() then gives the whole state to start over from.
+ *
+ * \param[in] node node whose view of the graph is queried
+ * \param[in] sequence sequence of the last change known by the caller, 0 for none
+ * \param[out] changes vector the changes are appended to
+ * \param[out] resync_needed whether the changes since `sequence` are not known anymore
+ * \return `RMW_RET_OK` if successful, or
+ * \return `RMW_RET_INVALID_ARGUMENT` if an argument is `NULL`, or
+ * \return `RMW_RET_INCORRECT_RMW_IMPLEMENTATION` if the node handle is from a different
+ *   rmw implementation
+ */
+RMW_FASTRTPS_CPP_PUBLIC
+rmw_ret_t
+get_graph_changes(
+  const rmw_node_t * node,
+  uint64_t sequence,
+  std::vector<rmw_fastrtps_shared_cpp::GraphChange> * changes,
+  bool * resync_needed);
+
+/// Return the endpoints currently known, as the changes which added them.
+/**
+ * An endpoint appears once per discovered instance, e.g. twice for a node
+ * with two publishers on the same topic.
+ *
+ * \param[in] node node whose view of the graph is queried
+ * \param[out] endpoints vector the endpoints are appended to
+ * \param[out] sequence sequence of the last change included, to pass to get_graph_changes()
+ * \return `RMW_RET_OK` if successful, or
+ * \return `RMW_RET_INVALID_ARGUMENT` if an argument is `NULL`, or
+ * \return `RMW_RET_INCORRECT_RMW_IMPLEMENTATION` if the node handle is from a different
+ *   rmw implementation
+ */
+RMW_FASTRTPS_CPP_PUBLIC
+rmw_ret_t
+get_graph_endpoints(
+  const rmw_node_t * node,
+  std::vector<rmw_fastrtps_shared_cpp::GraphChange> * endpoints,
+  uint64_t * sequence);
+
+}  // namespace rmw_fastrtps_cpp
+
+#endif  // RMW_FASTRTPS_CPP__GET_GRAPH_CHANGES_HPP_
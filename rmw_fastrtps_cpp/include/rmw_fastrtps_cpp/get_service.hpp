@@ -15,6 +15,8 @@
 #ifndef RMW_FASTRTPS_CPP__GET_SERVICE_HPP_
 #define RMW_FASTRTPS_CPP__GET_SERVICE_HPP_
 
+#include <cstdint>
+
 #include "fastrtps/publisher/Publisher.h"
 #include "fastrtps/subscriber/Subscriber.h"
 #include "rmw/rmw.h"
@@ -45,6 +47,21 @@ RMW_FASTRTPS_CPP_PUBLIC
 eprosima::fastrtps::Publisher *
 get_response_publisher(rmw_service_t * service);
 
+/// Return the number of requests dropped because too many were waiting to be taken.
+/**
+ * With a KEEP_LAST history QoS, a service queues at most `depth` requests and
+ * drops the oldest one to make room for a new one.
+ * With KEEP_ALL, none is dropped.
+ *
+ * The function returns `0` when either the service handle is `NULL` or
+ * when the service handle is from a different rmw implementation.
+ *
+ * \return number of dropped requests
+ */
+RMW_FASTRTPS_CPP_PUBLIC
+uint64_t
+get_dropped_request_count(rmw_service_t * service);
+
 }  // namespace rmw_fastrtps_cpp
 
 #endif  // RMW_FASTRTPS_CPP__GET_SERVICE_HPP_
@@ -33,6 +33,28 @@ RMW_FASTRTPS_CPP_PUBLIC
 eprosima::fastrtps::Subscriber *
 get_subscriber(rmw_subscription_t * subscription);
 
+/// Take up to `count` messages from a subscription in one call.
+/**
+ * Messages are taken in order into the `count` preallocated messages pointed
+ * to by `ros_messages`, and their infos into `message_infos` unless it is `NULL`.
+ * This is a convenience over calling rmw_take_with_info() in a loop, which only
+ * refreshes the state of the subscription once at the end.
+ *
+ * \param[out] taken number of messages taken, the first `taken` entries are valid
+ * \return `RMW_RET_OK` if successful, even if no message was taken, or
+ * \return `RMW_RET_ERROR` if an argument is `NULL` or the subscription handle
+ *   is from a different rmw implementation
+ */
+RMW_FASTRTPS_CPP_PUBLIC
+rmw_ret_t
+take_sequence(
+  const rmw_subscription_t * subscription,
+  size_t count,
+  void * const * ros_messages,
+  rmw_message_info_t * message_infos,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation);
+
 }  // namespace rmw_fastrtps_cpp
 
 #endif  // RMW_FASTRTPS_CPP__GET_SUBSCRIBER_HPP_
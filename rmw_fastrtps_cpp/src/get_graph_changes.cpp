@@ -0,0 +1,44 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_cpp/get_graph_changes.hpp"
+
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_cpp/identifier.hpp"
+
+namespace rmw_fastrtps_cpp
+{
+
+rmw_ret_t
+get_graph_changes(
+  const rmw_node_t * node,
+  uint64_t sequence,
+  std::vector<rmw_fastrtps_shared_cpp::GraphChange> * changes,
+  bool * resync_needed)
+{
+  return rmw_fastrtps_shared_cpp::__rmw_get_graph_changes(
+    eprosima_fastrtps_identifier, node, sequence, changes, resync_needed);
+}
+
+rmw_ret_t
+get_graph_endpoints(
+  const rmw_node_t * node,
+  std::vector<rmw_fastrtps_shared_cpp::GraphChange> * endpoints,
+  uint64_t * sequence)
+{
+  return rmw_fastrtps_shared_cpp::__rmw_get_graph_endpoints(
+    eprosima_fastrtps_identifier, node, endpoints, sequence);
+}
+
+}  // namespace rmw_fastrtps_cpp
@@ -95,6 +95,8 @@ rmw_create_client(
   info->typesupport_identifier_ = type_support->typesupport_identifier;
   info->request_publisher_matched_count_ = 0;
   info->response_subscriber_matched_count_ = 0;
+  info->server_available_ = false;
+  info->graph_guard_condition_ = impl->graph_guard_condition;
 
   const service_type_support_callbacks_t * service_members;
   const message_type_support_callbacks_t * request_members;
@@ -160,7 +162,7 @@ rmw_create_client(
     RMW_SET_ERROR_MSG("failed to get datareader qos");
     goto fail;
   }
-  info->listener_ = new ClientListener(info);
+  info->listener_ = new ClientListener(info, subscriberParam.topic.historyQos);
   info->response_subscriber_ =
     Domain::createSubscriber(participant, subscriberParam, info->listener_);
   if (!info->response_subscriber_) {
@@ -134,6 +134,10 @@ rmw_create_publisher(
   }
 
   info->typesupport_identifier_ = type_support->typesupport_identifier;
+  if (info->typesupport_identifier_ == RMW_FASTRTPS_CPP_TYPESUPPORT_CPP) {
+    info->loan_pool_.reset(
+      _create_loaned_message_pool(type_supports, &info->loan_type_support_));
+  }
 
   auto callbacks = static_cast<const message_type_support_callbacks_t *>(type_support->data);
   std::string type_name = _create_type_name(callbacks);
@@ -202,7 +206,7 @@ rmw_create_publisher(
     RMW_SET_ERROR_MSG("failed to allocate publisher");
     goto fail;
   }
-  rmw_publisher->can_loan_messages = false;
+  rmw_publisher->can_loan_messages = info->loan_pool_ != nullptr;
   rmw_publisher->implementation_identifier = eprosima_fastrtps_identifier;
   rmw_publisher->data = info;
   rmw_publisher->topic_name = reinterpret_cast<char *>(rmw_allocate(strlen(topic_name) + 1));
@@ -267,12 +271,8 @@ rmw_borrow_loaned_message(
   const rosidl_message_type_support_t * type_support,
   void ** ros_message)
 {
-  (void) publisher;
-  (void) type_support;
-  (void) ros_message;
-
-  RMW_SET_ERROR_MSG("rmw_borrow_loaned_message not implemented for rmw_fastrtps_cpp");
-  return RMW_RET_UNSUPPORTED;
+  return rmw_fastrtps_shared_cpp::__rmw_borrow_loaned_message(
+    eprosima_fastrtps_identifier, publisher, type_support, ros_message);
 }
 
 rmw_ret_t
@@ -280,12 +280,8 @@ rmw_return_loaned_message_from_publisher(
   const rmw_publisher_t * publisher,
   void * loaned_message)
 {
-  (void) publisher;
-  (void) loaned_message;
-
-  RMW_SET_ERROR_MSG(
-    "rmw_return_loaned_message_from_publisher not implemented for rmw_fastrtps_cpp");
-  return RMW_RET_UNSUPPORTED;
+  return rmw_fastrtps_shared_cpp::__rmw_return_loaned_message_from_publisher(
+    eprosima_fastrtps_identifier, publisher, loaned_message);
 }
 
 rmw_ret_t
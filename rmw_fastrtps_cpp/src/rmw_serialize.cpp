@@ -18,15 +18,16 @@
 #include "rmw/serialized_message.h"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/typesupport_cache.hpp"
+
 #include "./type_support_common.hpp"
 
-extern "C"
+namespace
 {
-rmw_ret_t
-rmw_serialize(
-  const void * ros_message,
-  const rosidl_message_type_support_t * type_support,
-  rmw_serialized_message_t * serialized_message)
+
+// Typesupports are built once per message type and shared by all the calls.
+rmw_fastrtps_shared_cpp::TypeSupport *
+_get_message_type_support(const rosidl_message_type_support_t * type_support)
 {
   const rosidl_message_type_support_t * ts = get_message_typesupport_handle(
     type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
@@ -35,12 +36,33 @@ rmw_serialize(
       type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
     if (!ts) {
       RMW_SET_ERROR_MSG("type support not from this implementation");
-      return RMW_RET_ERROR;
+      return nullptr;
     }
   }
 
-  auto callbacks = static_cast<const message_type_support_callbacks_t *>(ts->data);
-  auto tss = new MessageTypeSupport_cpp(callbacks);
+  static rmw_fastrtps_shared_cpp::TypeSupportCache cache;
+  return cache.get(
+    ts,
+    [ts]() -> rmw_fastrtps_shared_cpp::TypeSupport * {
+      auto callbacks = static_cast<const message_type_support_callbacks_t *>(ts->data);
+      return new MessageTypeSupport_cpp(callbacks);
+    });
+}
+
+}  // namespace
+
+extern "C"
+{
+rmw_ret_t
+rmw_serialize(
+  const void * ros_message,
+  const rosidl_message_type_support_t * type_support,
+  rmw_serialized_message_t * serialized_message)
+{
+  auto tss = _get_message_type_support(type_support);
+  if (!tss) {
+    return RMW_RET_ERROR;
+  }
   auto data_length = tss->getEstimatedSerializedSize(ros_message);
   if (serialized_message->buffer_capacity < data_length) {
     if (rmw_serialized_message_resize(serialized_message, data_length) != RMW_RET_OK) {
@@ -57,7 +79,6 @@ rmw_serialize(
   auto ret = tss->serializeROSmessage(ros_message, ser);
   serialized_message->buffer_length = data_length;
   serialized_message->buffer_capacity = data_length;
-  delete tss;
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
@@ -67,36 +88,40 @@ rmw_deserialize(
   const rosidl_message_type_support_t * type_support,
   void * ros_message)
 {
-  const rosidl_message_type_support_t * ts = get_message_typesupport_handle(
-    type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
-  if (!ts) {
-    ts = get_message_typesupport_handle(
-      type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
-    if (!ts) {
-      RMW_SET_ERROR_MSG("type support not from this implementation");
-      return RMW_RET_ERROR;
-    }
+  auto tss = _get_message_type_support(type_support);
+  if (!tss) {
+    return RMW_RET_ERROR;
   }
-
-  auto callbacks = static_cast<const message_type_support_callbacks_t *>(ts->data);
-  auto tss = new MessageTypeSupport_cpp(callbacks);
   eprosima::fastcdr::FastBuffer buffer(
     reinterpret_cast<char *>(serialized_message->buffer), serialized_message->buffer_length);
   eprosima::fastcdr::Cdr deser(buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
     eprosima::fastcdr::Cdr::DDS_CDR);
 
   auto ret = tss->deserializeROSmessage(deser, ros_message);
-  delete tss;
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
 rmw_ret_t
 rmw_get_serialized_message_size(
-  const rosidl_message_type_support_t * /*type_support*/,
-  const rosidl_message_bounds_t * /*message_bounds*/,
-  size_t * /*size*/)
+  const rosidl_message_type_support_t * type_support,
+  const rosidl_message_bounds_t * message_bounds,
+  size_t * size)
 {
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(size, RMW_RET_INVALID_ARGUMENT);
+  // Only the bound computed from the type definition is known here
+  (void)message_bounds;
+
+  auto tss = _get_message_type_support(type_support);
+  if (!tss) {
+    return RMW_RET_ERROR;
+  }
+  if (!tss->isBounded()) {
+    RMW_SET_ERROR_MSG("the serialized size of unbounded message types is not known in advance");
+    return RMW_RET_ERROR;
+  }
+  // Includes the encapsulation, like the messages produced by rmw_serialize()
+  *size = tss->m_typeSize;
+  return RMW_RET_OK;
 }
 }  // extern "C"
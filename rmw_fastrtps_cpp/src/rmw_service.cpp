@@ -170,7 +170,7 @@ rmw_create_service(
     RMW_SET_ERROR_MSG("failed to get datareader qos");
     goto fail;
   }
-  info->listener_ = new ServiceListener(info);
+  info->listener_ = new ServiceListener(info, subscriberParam.topic.historyQos);
   info->request_subscriber_ =
     Domain::createSubscriber(participant, subscriberParam, info->listener_);
   if (!info->request_subscriber_) {
@@ -12,10 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <new>
 #include <string>
 
 #include "rmw/error_handling.h"
 
+#include "rosidl_typesupport_introspection_cpp/field_types.hpp"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
 #include "type_support_common.hpp"
 
 namespace rmw_fastrtps_cpp
@@ -135,3 +140,59 @@ ResponseTypeSupport::ResponseTypeSupport(const service_type_support_callbacks_t
 }
 
 }  // namespace rmw_fastrtps_cpp
+
+using MessageMembers_cpp = rosidl_typesupport_introspection_cpp::MessageMembers;
+
+static
+bool
+is_plain_message(const MessageMembers_cpp * members)
+{
+  for (uint32_t i = 0; i < members->member_count_; ++i) {
+    const auto & member = members->members_[i];
+    if (member.is_array_ && (member.array_size_ == 0 || member.is_upper_bound_)) {
+      return false;
+    }
+    switch (member.type_id_) {
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
+        return false;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
+        if (!is_plain_message(static_cast<const MessageMembers_cpp *>(member.members_->data))) {
+          return false;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+rmw_fastrtps_shared_cpp::LoanedMessagePool *
+_create_loaned_message_pool(
+  const rosidl_message_type_support_t * type_supports,
+  const rosidl_message_type_support_t ** loan_type_support)
+{
+  const rosidl_message_type_support_t * introspection_type_support =
+    get_message_typesupport_handle(
+    type_supports, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+  if (!introspection_type_support) {
+    return nullptr;
+  }
+  auto members = static_cast<const MessageMembers_cpp *>(introspection_type_support->data);
+  if (!is_plain_message(members)) {
+    return nullptr;
+  }
+
+  auto init = [members](void * ros_message) {
+      members->init_function(ros_message, rosidl_generator_cpp::MessageInitialization::ALL);
+    };
+  auto fini = [members](void * ros_message) {
+      members->fini_function(ros_message);
+    };
+  if (loan_type_support) {
+    *loan_type_support = introspection_type_support;
+  }
+  return new (std::nothrow) rmw_fastrtps_shared_cpp::LoanedMessagePool(
+    members->size_of_, init, fini);
+}
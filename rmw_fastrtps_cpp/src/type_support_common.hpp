@@ -24,6 +24,7 @@
 #include "rmw/error_handling.h"
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
 
 #include "rmw_fastrtps_cpp/MessageTypeSupport.hpp"
 #include "rmw_fastrtps_cpp/ServiceTypeSupport.hpp"
@@ -69,4 +70,19 @@ _register_type(
   eprosima::fastrtps::Domain::registerType(participant, typed_typesupport);
 }
 
+/// Create the pool of messages lent by an entity of the given type, if it can loan.
+/**
+ * Loaning is only supported for plain C++ message types, i.e. without strings
+ * or sequences, whose size and constructor are taken from their introspection
+ * type support.
+ *
+ * \param[out] loan_type_support if not null, set to the introspection type support
+ *   the messages of the pool are made with.
+ * \return a new pool, or `nullptr` if the type cannot be loaned
+ */
+rmw_fastrtps_shared_cpp::LoanedMessagePool *
+_create_loaned_message_pool(
+  const rosidl_message_type_support_t * type_supports,
+  const rosidl_message_type_support_t ** loan_type_support = nullptr);
+
 #endif  // TYPE_SUPPORT_COMMON_HPP_
@@ -57,6 +57,8 @@ MessageTypeSupport<MembersType>::MessageTypeSupport(const MembersType * members)
   } else {
     this->m_typeSize++;
   }
+
+  this->compileSerializationPlan();
 }
 
 }  // namespace rmw_fastrtps_dynamic_cpp
@@ -61,6 +61,8 @@ RequestTypeSupport<ServiceMembersType, MessageMembersType>::RequestTypeSupport(
   } else {
     this->m_typeSize++;
   }
+
+  this->compileSerializationPlan();
 }
 
 template<typename ServiceMembersType, typename MessageMembersType>
@@ -90,6 +92,8 @@ ResponseTypeSupport<ServiceMembersType, MessageMembersType>::ResponseTypeSupport
   } else {
     this->m_typeSize++;
   }
+
+  this->compileSerializationPlan();
 }
 
 }  // namespace rmw_fastrtps_dynamic_cpp
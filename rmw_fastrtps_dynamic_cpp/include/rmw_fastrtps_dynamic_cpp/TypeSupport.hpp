@@ -24,6 +24,8 @@
 #include <fastcdr/Cdr.h>
 #include <cassert>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "rcutils/logging_macros.h"
 
@@ -49,8 +51,8 @@ namespace rmw_fastrtps_dynamic_cpp
 template<typename MembersType>
 struct StringHelper;
 
-// For C introspection typesupport we create intermediate instances of std::string so that
-// eprosima::fastcdr::Cdr can handle the string properly.
+// For C introspection typesupport strings are serialized straight from their character data,
+// and we create intermediate instances of std::string to deserialize them.
 template<>
 struct StringHelper<rosidl_typesupport_introspection_c__MessageMembers>
 {
@@ -77,7 +79,7 @@ struct StringHelper<rosidl_typesupport_introspection_c__MessageMembers>
     return current_alignment + strlen(c_string->data) + 1;
   }
 
-  static std::string convert_to_std_string(void * data)
+  static const char * get_c_string(void * data)
   {
     auto c_string = static_cast<rosidl_generator_c__String *>(data);
     if (!c_string) {
@@ -92,12 +94,7 @@ struct StringHelper<rosidl_typesupport_introspection_c__MessageMembers>
         "rosidl_generator_c_String had invalid data");
       return "";
     }
-    return std::string(c_string->data);
-  }
-
-  static std::string convert_to_std_string(rosidl_generator_c__String & data)
-  {
-    return std::string(data.data);
+    return c_string->data;
   }
 
   static void assign(eprosima::fastcdr::Cdr & deser, void * field, bool)
@@ -138,6 +135,10 @@ public:
 
   bool serializeROSmessage(const void * ros_message, eprosima::fastcdr::Cdr & ser);
 
+  bool serializeROSmessageWithScratch(
+    const void * ros_message, eprosima::fastcdr::Cdr & ser,
+    rmw_fastrtps_shared_cpp::SerializationScratch & scratch);
+
   bool deserializeROSmessage(eprosima::fastcdr::Cdr & deser, void * ros_message);
 
 protected:
@@ -145,18 +146,72 @@ protected:
 
   size_t calculateMaxSerializedSize(const MembersType * members, size_t current_alignment);
 
+  // Must be called once members_ is set, before any (de)serialization.
+  // Without merging the runs of primitive members, every member is (de)serialized on its own.
+  void compileSerializationPlan(bool merge_pod_runs = true);
+
   const MembersType * members_;
 
 private:
+  using MemberType = typename std::remove_const<
+    typename std::remove_pointer<decltype(MembersType::members_)>::type>::type;
+
+  // One step of a serialization plan, which flattens the introspection tree of a message.
+  struct PlanOp
+  {
+    enum Kind
+    {
+      // A single member, (de)serialized by the functions below.
+      FIELD,
+      // Primitive members laid out in memory exactly like in CDR, copied as a single block
+      // of `size` bytes when the stream position allows it. Otherwise the `run_length`
+      // FIELD operations that follow are executed instead.
+      POD_RUN,
+      // An array or sequence of messages, each element executing sub_plans_[sub_plan].
+      MESSAGE_ARRAY,
+    };
+
+    Kind kind;
+    const MemberType * member;
+    // Offset from the start of the message the plan is executed on.
+    size_t offset;
+
+    void (* serialize)(
+      const MemberType *, void *, eprosima::fastcdr::Cdr &,
+      rmw_fastrtps_shared_cpp::SerializationScratch &);
+    void (* deserialize)(const MemberType *, void *, eprosima::fastcdr::Cdr &, bool);
+    size_t (* next_field_align)(const MemberType *, void *, size_t);
+
+    size_t size;
+    size_t first_alignment;
+    size_t max_alignment;
+    size_t run_length;
+
+    size_t sub_plan;
+    size_t element_size;
+    size_t element_alignment;
+  };
+
+  using Plan = std::vector<PlanOp>;
+
+  void compilePlan(
+    const MembersType * members, size_t base_offset, bool merge_pod_runs, Plan & plan);
+
+  static void mergePodRuns(Plan & plan);
+
   size_t getEstimatedSerializedSize(
-    const MembersType * members, const void * ros_message, size_t current_alignment);
+    const Plan & plan, const void * ros_message, size_t current_alignment);
+
+  void serializeROSmessage(
+    eprosima::fastcdr::Cdr & ser, const Plan & plan, const void * ros_message,
+    size_t origin, rmw_fastrtps_shared_cpp::SerializationScratch & scratch);
 
-  bool serializeROSmessage(
-    eprosima::fastcdr::Cdr & ser, const MembersType * members, const void * ros_message);
+  void deserializeROSmessage(
+    eprosima::fastcdr::Cdr & deser, const Plan & plan, void * ros_message,
+    size_t origin, bool call_new);
 
-  bool deserializeROSmessage(
-    eprosima::fastcdr::Cdr & deser, const MembersType * members, void * ros_message,
-    bool call_new);
+  Plan plan_;
+  std::vector<Plan> sub_plans_;
 };
 
 }  // namespace rmw_fastrtps_dynamic_cpp
@@ -17,8 +17,11 @@
 
 #include <fastcdr/FastBuffer.h>
 #include <fastcdr/Cdr.h>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "rmw_fastrtps_dynamic_cpp/TypeSupport.hpp"
@@ -207,20 +210,184 @@ static size_t calculateMaxAlign(const MembersType * members)
   return max_align;
 }
 
+// Primitive arrays and sequences are moved as whole blocks.
+// Fast-CDR already copies them at once when the payload has the native endianness, so only
+// the other endianness needs help: the bytes are swapped here over the whole block instead of
+// being written or read one element at a time.
+inline uint16_t swap_bytes(uint16_t value)
+{
+  return static_cast<uint16_t>((value << 8) | (value >> 8));
+}
+
+inline uint32_t swap_bytes(uint32_t value)
+{
+  return ((value & 0x000000FFu) << 24) | ((value & 0x0000FF00u) << 8) |
+         ((value & 0x00FF0000u) >> 8) | ((value & 0xFF000000u) >> 24);
+}
+
+inline uint64_t swap_bytes(uint64_t value)
+{
+  return (static_cast<uint64_t>(swap_bytes(static_cast<uint32_t>(value))) << 32) |
+         swap_bytes(static_cast<uint32_t>(value >> 32));
+}
+
+template<size_t Size>
+struct UnsignedOfSize;
+
+template<>
+struct UnsignedOfSize<2>
+{
+  using type = uint16_t;
+};
+
+template<>
+struct UnsignedOfSize<4>
+{
+  using type = uint32_t;
+};
+
+template<>
+struct UnsignedOfSize<8>
+{
+  using type = uint64_t;
+};
+
+template<typename T>
+void swap_array_bytes(char * bytes, size_t count)
+{
+  using U = typename UnsignedOfSize<sizeof(T)>::type;
+  for (size_t i = 0; i < count; ++i, bytes += sizeof(T)) {
+    U value;
+    memcpy(&value, bytes, sizeof(T));
+    value = swap_bytes(value);
+    memcpy(bytes, &value, sizeof(T));
+  }
+}
+
+// Multi-byte primitive types, whose bytes depend on the endianness.
+template<typename T>
+struct IsByteSwappable
+  : std::integral_constant<bool, std::is_arithmetic<T>::value && (sizeof(T) > 1)>
+{
+};
+
+template<typename T>
+typename std::enable_if<!IsByteSwappable<T>::value>::type
+serialize_array(eprosima::fastcdr::Cdr & ser, const T * data, size_t size)
+{
+  ser.serializeArray(data, size);
+}
+
+template<typename T>
+typename std::enable_if<IsByteSwappable<T>::value>::type
+serialize_array(eprosima::fastcdr::Cdr & ser, const T * data, size_t size)
+{
+  if (size == 0 || ser.endianness() == eprosima::fastcdr::Cdr::DEFAULT_ENDIAN) {
+    ser.serializeArray(data, size);
+    return;
+  }
+  // The first element aligns the stream, the next ones follow without padding.
+  ser << data[0];
+  const char * bytes = reinterpret_cast<const char *>(data + 1);
+  size_t remaining = (size - 1) * sizeof(T);
+  char chunk[512];
+  while (remaining > 0) {
+    size_t length = std::min(remaining, sizeof(chunk));
+    memcpy(chunk, bytes, length);
+    swap_array_bytes<T>(chunk, length / sizeof(T));
+    ser.serializeArray(chunk, length);
+    bytes += length;
+    remaining -= length;
+  }
+}
+
+template<typename T>
+typename std::enable_if<!IsByteSwappable<T>::value>::type
+deserialize_array(eprosima::fastcdr::Cdr & deser, T * data, size_t size)
+{
+  deser.deserializeArray(data, size);
+}
+
+template<typename T>
+typename std::enable_if<IsByteSwappable<T>::value>::type
+deserialize_array(eprosima::fastcdr::Cdr & deser, T * data, size_t size)
+{
+  if (size == 0 || deser.endianness() == eprosima::fastcdr::Cdr::DEFAULT_ENDIAN) {
+    deser.deserializeArray(data, size);
+    return;
+  }
+  deser >> data[0];
+  char * bytes = reinterpret_cast<char *>(data + 1);
+  deser.deserializeArray(bytes, (size - 1) * sizeof(T));
+  swap_array_bytes<T>(bytes, size - 1);
+}
+
+template<typename T>
+void serialize_sequence(eprosima::fastcdr::Cdr & ser, const std::vector<T> & data)
+{
+  ser << static_cast<uint32_t>(data.size());
+  serialize_array(ser, data.data(), data.size());
+}
+
+// std::vector<bool> stores bits, they are expanded to CDR bytes a chunk at a time.
+inline void serialize_sequence(eprosima::fastcdr::Cdr & ser, const std::vector<bool> & data)
+{
+  ser << static_cast<uint32_t>(data.size());
+  char chunk[512];
+  for (size_t i = 0; i < data.size(); ) {
+    size_t length = std::min(data.size() - i, sizeof(chunk));
+    for (size_t j = 0; j < length; ++j) {
+      chunk[j] = data[i + j] ? 1 : 0;
+    }
+    ser.serializeArray(chunk, length);
+    i += length;
+  }
+}
+
+template<typename T>
+void deserialize_sequence(eprosima::fastcdr::Cdr & deser, std::vector<T> & data)
+{
+  uint32_t size = 0;
+  deser >> size;
+  data.resize(size);
+  deserialize_array(deser, data.data(), data.size());
+}
+
+inline void deserialize_sequence(eprosima::fastcdr::Cdr & deser, std::vector<bool> & data)
+{
+  uint32_t size = 0;
+  deser >> size;
+  data.resize(size);
+  char chunk[512];
+  for (size_t i = 0; i < data.size(); ) {
+    size_t length = std::min(data.size() - i, sizeof(chunk));
+    deser.deserializeArray(chunk, length);
+    for (size_t j = 0; j < length; ++j) {
+      if (chunk[j] != 0 && chunk[j] != 1) {
+        throw std::runtime_error("unexpected value for a bool, expected 0 or 1");
+      }
+      data[i + j] = chunk[j] == 1;
+    }
+    i += length;
+  }
+}
+
 // C++ specialization
 template<typename T>
 void serialize_field(
   const rosidl_typesupport_introspection_cpp::MessageMember * member,
   void * field,
-  eprosima::fastcdr::Cdr & ser)
+  eprosima::fastcdr::Cdr & ser,
+  rmw_fastrtps_shared_cpp::SerializationScratch & scratch)
 {
+  (void)scratch;
   if (!member->is_array_) {
     ser << *static_cast<T *>(field);
   } else if (member->array_size_ && !member->is_upper_bound_) {
-    ser.serializeArray(static_cast<T *>(field), member->array_size_);
+    serialize_array(ser, static_cast<T *>(field), member->array_size_);
   } else {
     std::vector<T> & data = *reinterpret_cast<std::vector<T> *>(field);
-    ser << data;
+    serialize_sequence(ser, data);
   }
 }
 
@@ -229,9 +396,11 @@ inline
 void serialize_field<std::wstring>(
   const rosidl_typesupport_introspection_cpp::MessageMember * member,
   void * field,
-  eprosima::fastcdr::Cdr & ser)
+  eprosima::fastcdr::Cdr & ser,
+  rmw_fastrtps_shared_cpp::SerializationScratch & scratch)
 {
-  std::wstring wstr;
+  std::wstring & wstr = scratch.wstring_buffer();
+  size_t capacity = wstr.capacity();
   if (!member->is_array_) {
     auto u16str = static_cast<std::u16string *>(field);
     rosidl_typesupport_fastrtps_cpp::u16string_to_wstring(*u16str, wstr);
@@ -251,6 +420,9 @@ void serialize_field<std::wstring>(
       ser << wstr;
     }
   }
+  if (wstr.capacity() != capacity) {
+    scratch.count_allocation();
+  }
 }
 
 // C specialization
@@ -258,15 +430,18 @@ template<typename T>
 void serialize_field(
   const rosidl_typesupport_introspection_c__MessageMember * member,
   void * field,
-  eprosima::fastcdr::Cdr & ser)
+  eprosima::fastcdr::Cdr & ser,
+  rmw_fastrtps_shared_cpp::SerializationScratch & scratch)
 {
+  (void)scratch;
   if (!member->is_array_) {
     ser << *static_cast<T *>(field);
   } else if (member->array_size_ && !member->is_upper_bound_) {
-    ser.serializeArray(static_cast<T *>(field), member->array_size_);
+    serialize_array(ser, static_cast<T *>(field), member->array_size_);
   } else {
     auto & data = *reinterpret_cast<typename GenericCSequence<T>::type *>(field);
-    ser.serializeSequence(reinterpret_cast<T *>(data.data), data.size);
+    ser << static_cast<uint32_t>(data.size);
+    serialize_array(ser, reinterpret_cast<T *>(data.data), data.size);
   }
 }
 
@@ -275,37 +450,33 @@ inline
 void serialize_field<std::string>(
   const rosidl_typesupport_introspection_c__MessageMember * member,
   void * field,
-  eprosima::fastcdr::Cdr & ser)
+  eprosima::fastcdr::Cdr & ser,
+  rmw_fastrtps_shared_cpp::SerializationScratch & scratch)
 {
+  (void)scratch;
+  // Character data is serialized in place, Cdr writes the same length and
+  // terminating null it would for an equal std::string.
   using CStringHelper = StringHelper<rosidl_typesupport_introspection_c__MessageMembers>;
   if (!member->is_array_) {
-    auto && str = CStringHelper::convert_to_std_string(field);
+    const char * str = CStringHelper::get_c_string(field);
     // Control maximum length.
-    if (member->string_upper_bound_ && str.length() > member->string_upper_bound_ + 1) {
+    if (member->string_upper_bound_ && strlen(str) > member->string_upper_bound_ + 1) {
       throw std::runtime_error("string overcomes the maximum length");
     }
-    ser << str;
+    ser.serialize(str);
   } else {
-    // First, cast field to rosidl_generator_c
-    // Then convert to a std::string using StringHelper and serialize the std::string
     if (member->array_size_ && !member->is_upper_bound_) {
-      // tmpstring is defined here and not below to avoid
-      // memory allocation in every iteration of the for loop
-      std::string tmpstring;
       auto string_field = static_cast<rosidl_generator_c__String *>(field);
       for (size_t i = 0; i < member->array_size_; ++i) {
-        tmpstring = string_field[i].data;
-        ser.serialize(tmpstring);
+        ser.serialize(static_cast<const char *>(string_field[i].data));
       }
     } else {
       auto & string_sequence_field =
         *reinterpret_cast<rosidl_generator_c__String__Sequence *>(field);
-      std::vector<std::string> cpp_string_vector;
+      ser << static_cast<uint32_t>(string_sequence_field.size);
       for (size_t i = 0; i < string_sequence_field.size; ++i) {
-        cpp_string_vector.push_back(
-          CStringHelper::convert_to_std_string(string_sequence_field.data[i]));
+        ser.serialize(CStringHelper::get_c_string(&string_sequence_field.data[i]));
       }
-      ser << cpp_string_vector;
     }
   }
 }
@@ -315,9 +486,11 @@ inline
 void serialize_field<std::wstring>(
   const rosidl_typesupport_introspection_c__MessageMember * member,
   void * field,
-  eprosima::fastcdr::Cdr & ser)
+  eprosima::fastcdr::Cdr & ser,
+  rmw_fastrtps_shared_cpp::SerializationScratch & scratch)
 {
-  std::wstring wstr;
+  std::wstring & wstr = scratch.wstring_buffer();
+  size_t capacity = wstr.capacity();
   if (!member->is_array_) {
     auto u16str = static_cast<rosidl_generator_c__U16String *>(field);
     rosidl_typesupport_fastrtps_c::u16string_to_wstring(*u16str, wstr);
@@ -336,7 +509,11 @@ void serialize_field<std::wstring>(
       ser << wstr;
     }
   }
+  if (wstr.capacity() != capacity) {
+    scratch.count_allocation();
+  }
 }
+
 inline
 size_t get_array_size_and_assign_field(
   const rosidl_typesupport_introspection_cpp::MessageMember * member,
@@ -370,102 +547,6 @@ size_t get_array_size_and_assign_field(
   return tmpsequence->size;
 }
 
-template<typename MembersType>
-bool TypeSupport<MembersType>::serializeROSmessage(
-  eprosima::fastcdr::Cdr & ser, const MembersType * members, const void * ros_message)
-{
-  assert(members);
-  assert(ros_message);
-
-  for (uint32_t i = 0; i < members->member_count_; ++i) {
-    const auto member = members->members_ + i;
-    void * field = const_cast<char *>(static_cast<const char *>(ros_message)) + member->offset_;
-    switch (member->type_id_) {
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOL:
-        if (!member->is_array_) {
-          // don't cast to bool here because if the bool is
-          // uninitialized the random value can't be deserialized
-          ser << (*static_cast<uint8_t *>(field) ? true : false);
-        } else {
-          serialize_field<bool>(member, field, ser);
-        }
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
-        serialize_field<uint8_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
-        serialize_field<char>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
-        serialize_field<float>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
-        serialize_field<double>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
-        serialize_field<int16_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
-        serialize_field<uint16_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
-        serialize_field<int32_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
-        serialize_field<uint32_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
-        serialize_field<int64_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
-        serialize_field<uint64_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
-        serialize_field<std::string>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
-        serialize_field<std::wstring>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
-        {
-          auto sub_members = static_cast<const MembersType *>(member->members_->data);
-          if (!member->is_array_) {
-            serializeROSmessage(ser, sub_members, field);
-          } else {
-            void * subros_message = nullptr;
-            size_t array_size = 0;
-            size_t sub_members_size = sub_members->size_of_;
-            size_t max_align = calculateMaxAlign(sub_members);
-
-            if (member->array_size_ && !member->is_upper_bound_) {
-              subros_message = field;
-              array_size = member->array_size_;
-            } else {
-              array_size = get_array_size_and_assign_field(
-                member, field, subros_message, sub_members_size, max_align);
-
-              // Serialize length
-              ser << (uint32_t)array_size;
-            }
-
-            for (size_t index = 0; index < array_size; ++index) {
-              serializeROSmessage(ser, sub_members, subros_message);
-              subros_message = static_cast<char *>(subros_message) + sub_members_size;
-              subros_message = align_(max_align, subros_message);
-            }
-          }
-        }
-        break;
-      default:
-        throw std::runtime_error("unknown type");
-    }
-  }
-
-  return true;
-}
-
 // C++ specialization
 template<typename T>
 size_t next_field_align(
@@ -628,99 +709,6 @@ size_t next_field_align_string<std::wstring>(
   return current_alignment;
 }
 
-template<typename MembersType>
-size_t TypeSupport<MembersType>::getEstimatedSerializedSize(
-  const MembersType * members, const void * ros_message, size_t current_alignment)
-{
-  assert(members);
-  assert(ros_message);
-
-  size_t initial_alignment = current_alignment;
-
-  for (uint32_t i = 0; i < members->member_count_; ++i) {
-    const auto member = members->members_ + i;
-    void * field = const_cast<char *>(static_cast<const char *>(ros_message)) + member->offset_;
-    switch (member->type_id_) {
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOL:
-        current_alignment = next_field_align<bool>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
-        current_alignment = next_field_align<uint8_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
-        current_alignment = next_field_align<char>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
-        current_alignment = next_field_align<float>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
-        current_alignment = next_field_align<double>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
-        current_alignment = next_field_align<int16_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
-        current_alignment = next_field_align<uint16_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
-        current_alignment = next_field_align<int32_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
-        current_alignment = next_field_align<uint32_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
-        current_alignment = next_field_align<int64_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
-        current_alignment = next_field_align<uint64_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
-        current_alignment = next_field_align_string<std::string>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
-        current_alignment = next_field_align_string<std::wstring>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
-        {
-          auto sub_members = static_cast<const MembersType *>(member->members_->data);
-          if (!member->is_array_) {
-            current_alignment += getEstimatedSerializedSize(sub_members, field, current_alignment);
-          } else {
-            void * subros_message = nullptr;
-            size_t array_size = 0;
-            size_t sub_members_size = sub_members->size_of_;
-            size_t max_align = calculateMaxAlign(sub_members);
-
-            if (member->array_size_ && !member->is_upper_bound_) {
-              subros_message = field;
-              array_size = member->array_size_;
-            } else {
-              array_size = get_array_size_and_assign_field(
-                member, field, subros_message, sub_members_size, max_align);
-
-              // Length serialization
-              current_alignment += 4 + eprosima::fastcdr::Cdr::alignment(current_alignment, 4);
-            }
-
-            for (size_t index = 0; index < array_size; ++index) {
-              current_alignment += getEstimatedSerializedSize(
-                sub_members, subros_message, current_alignment);
-              subros_message = static_cast<char *>(subros_message) + sub_members_size;
-              subros_message = align_(max_align, subros_message);
-            }
-          }
-        }
-        break;
-      default:
-        throw std::runtime_error("unknown type");
-    }
-  }
-
-  return current_alignment - initial_alignment;
-}
-
 template<typename T>
 void deserialize_field(
   const rosidl_typesupport_introspection_cpp::MessageMember * member,
@@ -731,13 +719,13 @@ void deserialize_field(
   if (!member->is_array_) {
     deser >> *static_cast<T *>(field);
   } else if (member->array_size_ && !member->is_upper_bound_) {
-    deser.deserializeArray(static_cast<T *>(field), member->array_size_);
+    deserialize_array(deser, static_cast<T *>(field), member->array_size_);
   } else {
     auto & vector = *reinterpret_cast<std::vector<T> *>(field);
     if (call_new) {
       new(&vector) std::vector<T>;
     }
-    deser >> vector;
+    deserialize_sequence(deser, vector);
   }
 }
 
@@ -814,13 +802,21 @@ void deserialize_field(
   if (!member->is_array_) {
     deser >> *static_cast<T *>(field);
   } else if (member->array_size_ && !member->is_upper_bound_) {
-    deser.deserializeArray(static_cast<T *>(field), member->array_size_);
+    deserialize_array(deser, static_cast<T *>(field), member->array_size_);
   } else {
     auto & data = *reinterpret_cast<typename GenericCSequence<T>::type *>(field);
-    int32_t dsize = 0;
+    uint32_t dsize = 0;
     deser >> dsize;
-    GenericCSequence<T>::init(&data, dsize);
-    deser.deserializeArray(reinterpret_cast<T *>(data.data), dsize);
+    // Reuse the storage of the sequence when it is large enough
+    if (data.capacity < dsize) {
+      GenericCSequence<T>::fini(&data);
+      if (!GenericCSequence<T>::init(&data, dsize)) {
+        throw std::runtime_error("unable to allocate the sequence");
+      }
+    } else {
+      data.size = dsize;
+    }
+    deserialize_array(deser, reinterpret_cast<T *>(data.data), dsize);
   }
 }
 
@@ -946,94 +942,374 @@ inline size_t get_submessage_array_deserialize(
   return vsize;
 }
 
+// Scalar bools are sent as 0 or 1 even if the ros message holds another value
+// (e.g. when uninitialized), as any other value can't be deserialized.
+template<typename MemberType>
+void serialize_bool_field(
+  const MemberType * member,
+  void * field,
+  eprosima::fastcdr::Cdr & ser,
+  rmw_fastrtps_shared_cpp::SerializationScratch & scratch)
+{
+  if (!member->is_array_) {
+    ser << (*static_cast<uint8_t *>(field) ? true : false);
+  } else {
+    serialize_field<bool>(member, field, ser, scratch);
+  }
+}
+
+template<typename T, typename PlanOp>
+void set_field_functions(PlanOp & op)
+{
+  op.serialize = &serialize_field<T>;
+  op.deserialize = &deserialize_field<T>;
+  op.next_field_align = &next_field_align<T>;
+  op.element_size = sizeof(T);
+}
+
+template<typename T, typename PlanOp>
+void set_string_field_functions(PlanOp & op)
+{
+  op.serialize = &serialize_field<T>;
+  op.deserialize = &deserialize_field<T>;
+  op.next_field_align = &next_field_align_string<T>;
+}
+
+// Whether a POD_RUN starting at the (aligned) stream position can be copied as a single block.
+template<typename PlanOp>
+static inline bool
+pod_run_matches_position(const PlanOp & op, size_t position)
+{
+  // The run is laid out like in CDR when its offset and the stream position are congruent
+  // modulo the largest alignment in the run, since all the smaller ones divide it.
+  return position % op.max_alignment == op.offset % op.max_alignment;
+}
+
+template<typename PlanOp>
+static inline bool
+can_copy_pod_run(const PlanOp & op, size_t position, eprosima::fastcdr::Cdr::Endianness endianness)
+{
+  return pod_run_matches_position(op, position) &&
+         (op.max_alignment == 1 || endianness == eprosima::fastcdr::Cdr::DEFAULT_ENDIAN);
+}
+
 template<typename MembersType>
-bool TypeSupport<MembersType>::deserializeROSmessage(
-  eprosima::fastcdr::Cdr & deser, const MembersType * members, void * ros_message, bool call_new)
+void TypeSupport<MembersType>::compileSerializationPlan(bool merge_pod_runs)
+{
+  plan_.clear();
+  sub_plans_.clear();
+  compilePlan(members_, 0, merge_pod_runs, plan_);
+  if (merge_pod_runs) {
+    mergePodRuns(plan_);
+  }
+}
+
+template<typename MembersType>
+void TypeSupport<MembersType>::compilePlan(
+  const MembersType * members, size_t base_offset, bool merge_pod_runs, Plan & plan)
 {
   assert(members);
-  assert(ros_message);
 
   for (uint32_t i = 0; i < members->member_count_; ++i) {
-    const auto * member = members->members_ + i;
-    void * field = static_cast<char *>(ros_message) + member->offset_;
+    const auto member = members->members_ + i;
+    PlanOp op = PlanOp();
+    op.kind = PlanOp::FIELD;
+    op.member = member;
+    op.offset = base_offset + member->offset_;
     switch (member->type_id_) {
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOL:
-        deserialize_field<bool>(member, field, deser, call_new);
+        set_field_functions<bool>(op);
+        op.serialize = &serialize_bool_field<MemberType>;
+        // Never copied as-is, see serialize_bool_field
+        op.element_size = 0;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
-        deserialize_field<uint8_t>(member, field, deser, call_new);
+        set_field_functions<uint8_t>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
-        deserialize_field<char>(member, field, deser, call_new);
+        set_field_functions<char>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
-        deserialize_field<float>(member, field, deser, call_new);
+        set_field_functions<float>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
-        deserialize_field<double>(member, field, deser, call_new);
+        set_field_functions<double>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
-        deserialize_field<int16_t>(member, field, deser, call_new);
+        set_field_functions<int16_t>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
-        deserialize_field<uint16_t>(member, field, deser, call_new);
+        set_field_functions<uint16_t>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
-        deserialize_field<int32_t>(member, field, deser, call_new);
+        set_field_functions<int32_t>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
-        deserialize_field<uint32_t>(member, field, deser, call_new);
+        set_field_functions<uint32_t>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
-        deserialize_field<int64_t>(member, field, deser, call_new);
+        set_field_functions<int64_t>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
-        deserialize_field<uint64_t>(member, field, deser, call_new);
+        set_field_functions<uint64_t>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
-        deserialize_field<std::string>(member, field, deser, call_new);
+        set_string_field_functions<std::string>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
-        deserialize_field<std::wstring>(member, field, deser, call_new);
+        set_string_field_functions<std::wstring>(op);
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
         {
-          auto sub_members = (const MembersType *)member->members_->data;
+          auto sub_members = static_cast<const MembersType *>(member->members_->data);
           if (!member->is_array_) {
-            deserializeROSmessage(deser, sub_members, field, call_new);
-          } else {
-            void * subros_message = nullptr;
-            size_t array_size = 0;
-            size_t sub_members_size = sub_members->size_of_;
-            size_t max_align = calculateMaxAlign(sub_members);
-            bool recall_new = call_new;
-
-            if (member->array_size_ && !member->is_upper_bound_) {
-              subros_message = field;
-              array_size = member->array_size_;
-            } else {
-              array_size = get_submessage_array_deserialize(
-                member, deser, field, subros_message,
-                call_new, sub_members_size, max_align);
-              recall_new = true;
-            }
-
-            for (size_t index = 0; index < array_size; ++index) {
-              deserializeROSmessage(deser, sub_members, subros_message, recall_new);
-              subros_message = static_cast<char *>(subros_message) + sub_members_size;
-              subros_message = align_(max_align, subros_message);
-            }
+            // Nested messages are inlined in the plan of their parent.
+            compilePlan(sub_members, op.offset, merge_pod_runs, plan);
+            continue;
+          }
+          Plan sub_plan;
+          compilePlan(sub_members, 0, merge_pod_runs, sub_plan);
+          if (merge_pod_runs) {
+            mergePodRuns(sub_plan);
           }
+          sub_plans_.push_back(std::move(sub_plan));
+
+          op.kind = PlanOp::MESSAGE_ARRAY;
+          op.sub_plan = sub_plans_.size() - 1;
+          op.element_alignment = calculateMaxAlign(sub_members);
+          void * element_size = reinterpret_cast<void *>(sub_members->size_of_);
+          op.element_size = reinterpret_cast<size_t>(align_(op.element_alignment, element_size));
         }
         break;
       default:
         throw std::runtime_error("unknown type");
     }
+    plan.push_back(op);
   }
+}
 
-  return true;
+template<typename MembersType>
+void TypeSupport<MembersType>::mergePodRuns(Plan & plan)
+{
+  Plan merged;
+  merged.reserve(plan.size());
+
+  size_t i = 0;
+  while (i < plan.size()) {
+    // Find the longest sequence of primitive members starting at i which are laid out in
+    // memory as they would be in a CDR stream starting at the same position.
+    size_t end = i;
+    size_t run_end = 0;
+    size_t max_alignment = 1;
+    while (end < plan.size()) {
+      const PlanOp & op = plan[end];
+      const auto member = op.member;
+      bool fixed_size = !member->is_array_ || (member->array_size_ && !member->is_upper_bound_);
+      if (op.kind != PlanOp::FIELD || op.element_size == 0 || !fixed_size) {
+        break;
+      }
+      size_t start = op.offset;
+      if (end == i) {
+        if (op.offset % op.element_size != 0) {
+          break;
+        }
+      } else {
+        start = run_end + eprosima::fastcdr::Cdr::alignment(run_end, op.element_size);
+        if (start != op.offset) {
+          break;
+        }
+      }
+      run_end = start + op.element_size * (member->is_array_ ? member->array_size_ : 1);
+      if (op.element_size > max_alignment) {
+        max_alignment = op.element_size;
+      }
+      ++end;
+    }
+
+    if (end - i < 2) {
+      merged.push_back(plan[i]);
+      ++i;
+      continue;
+    }
+
+    PlanOp run = PlanOp();
+    run.kind = PlanOp::POD_RUN;
+    run.member = plan[i].member;
+    run.offset = plan[i].offset;
+    run.size = run_end - plan[i].offset;
+    run.first_alignment = plan[i].element_size;
+    run.max_alignment = max_alignment;
+    run.run_length = end - i;
+    merged.push_back(run);
+    merged.insert(merged.end(), plan.begin() + i, plan.begin() + end);
+    i = end;
+  }
+
+  plan.swap(merged);
+}
+
+template<typename MembersType>
+size_t TypeSupport<MembersType>::getEstimatedSerializedSize(
+  const Plan & plan, const void * ros_message, size_t current_alignment)
+{
+  assert(ros_message);
+
+  size_t initial_alignment = current_alignment;
+
+  for (size_t i = 0; i < plan.size(); ++i) {
+    const PlanOp & op = plan[i];
+    void * field = const_cast<char *>(static_cast<const char *>(ros_message)) + op.offset;
+    switch (op.kind) {
+      case PlanOp::FIELD:
+        current_alignment = op.next_field_align(op.member, field, current_alignment);
+        break;
+      case PlanOp::POD_RUN:
+        {
+          size_t start = current_alignment +
+            eprosima::fastcdr::Cdr::alignment(current_alignment, op.first_alignment);
+          if (pod_run_matches_position(op, start)) {
+            current_alignment = start + op.size;
+            i += op.run_length;
+          }
+        }
+        break;
+      case PlanOp::MESSAGE_ARRAY:
+        {
+          void * subros_message = nullptr;
+          size_t array_size = 0;
+
+          if (op.member->array_size_ && !op.member->is_upper_bound_) {
+            subros_message = field;
+            array_size = op.member->array_size_;
+          } else {
+            array_size = get_array_size_and_assign_field(
+              op.member, field, subros_message, op.element_size, op.element_alignment);
+
+            // Length serialization
+            current_alignment += 4 + eprosima::fastcdr::Cdr::alignment(current_alignment, 4);
+          }
+
+          const Plan & sub_plan = sub_plans_[op.sub_plan];
+          for (size_t index = 0; index < array_size; ++index) {
+            current_alignment += getEstimatedSerializedSize(
+              sub_plan, subros_message, current_alignment);
+            subros_message = static_cast<char *>(subros_message) + op.element_size;
+          }
+        }
+        break;
+    }
+  }
+
+  return current_alignment - initial_alignment;
+}
+
+template<typename MembersType>
+void TypeSupport<MembersType>::serializeROSmessage(
+  eprosima::fastcdr::Cdr & ser, const Plan & plan, const void * ros_message,
+  size_t origin, rmw_fastrtps_shared_cpp::SerializationScratch & scratch)
+{
+  assert(ros_message);
+
+  for (size_t i = 0; i < plan.size(); ++i) {
+    const PlanOp & op = plan[i];
+    void * field = const_cast<char *>(static_cast<const char *>(ros_message)) + op.offset;
+    switch (op.kind) {
+      case PlanOp::FIELD:
+        op.serialize(op.member, field, ser, scratch);
+        break;
+      case PlanOp::POD_RUN:
+        {
+          // Alignment is relative to the end of the encapsulation, i.e. to origin
+          size_t position = ser.getSerializedDataLength() - origin;
+          size_t padding = eprosima::fastcdr::Cdr::alignment(position, op.first_alignment);
+          if (can_copy_pod_run(op, position + padding, ser.endianness())) {
+            static const char zeros[8] = {};
+            ser.serializeArray(zeros, padding);
+            ser.serializeArray(static_cast<const char *>(field), op.size);
+            i += op.run_length;
+          }
+        }
+        break;
+      case PlanOp::MESSAGE_ARRAY:
+        {
+          void * subros_message = nullptr;
+          size_t array_size = 0;
+
+          if (op.member->array_size_ && !op.member->is_upper_bound_) {
+            subros_message = field;
+            array_size = op.member->array_size_;
+          } else {
+            array_size = get_array_size_and_assign_field(
+              op.member, field, subros_message, op.element_size, op.element_alignment);
+
+            // Serialize length
+            ser << (uint32_t)array_size;
+          }
+
+          const Plan & sub_plan = sub_plans_[op.sub_plan];
+          for (size_t index = 0; index < array_size; ++index) {
+            serializeROSmessage(ser, sub_plan, subros_message, origin, scratch);
+            subros_message = static_cast<char *>(subros_message) + op.element_size;
+          }
+        }
+        break;
+    }
+  }
+}
+
+template<typename MembersType>
+void TypeSupport<MembersType>::deserializeROSmessage(
+  eprosima::fastcdr::Cdr & deser, const Plan & plan, void * ros_message,
+  size_t origin, bool call_new)
+{
+  assert(ros_message);
+
+  for (size_t i = 0; i < plan.size(); ++i) {
+    const PlanOp & op = plan[i];
+    void * field = static_cast<char *>(ros_message) + op.offset;
+    switch (op.kind) {
+      case PlanOp::FIELD:
+        op.deserialize(op.member, field, deser, call_new);
+        break;
+      case PlanOp::POD_RUN:
+        {
+          size_t position = deser.getSerializedDataLength() - origin;
+          size_t padding = eprosima::fastcdr::Cdr::alignment(position, op.first_alignment);
+          if (can_copy_pod_run(op, position + padding, deser.endianness())) {
+            char skipped[8];
+            deser.deserializeArray(skipped, padding);
+            deser.deserializeArray(static_cast<char *>(field), op.size);
+            i += op.run_length;
+          }
+        }
+        break;
+      case PlanOp::MESSAGE_ARRAY:
+        {
+          void * subros_message = nullptr;
+          size_t array_size = 0;
+          bool recall_new = call_new;
+
+          if (op.member->array_size_ && !op.member->is_upper_bound_) {
+            subros_message = field;
+            array_size = op.member->array_size_;
+          } else {
+            array_size = get_submessage_array_deserialize(
+              op.member, deser, field, subros_message,
+              call_new, op.element_size, op.element_alignment);
+            recall_new = true;
+          }
+
+          const Plan & sub_plan = sub_plans_[op.sub_plan];
+          for (size_t index = 0; index < array_size; ++index) {
+            deserializeROSmessage(deser, sub_plan, subros_message, origin, recall_new);
+            subros_message = static_cast<char *>(subros_message) + op.element_size;
+          }
+        }
+        break;
+    }
+  }
 }
 
 template<typename MembersType>
@@ -1128,7 +1404,7 @@ size_t TypeSupport<MembersType>::getEstimatedSerializedSize(
   size_t ret_val = 4;
 
   if (members_->member_count_ != 0) {
-    ret_val += TypeSupport::getEstimatedSerializedSize(members_, ros_message, 0);
+    ret_val += TypeSupport::getEstimatedSerializedSize(plan_, ros_message, 0);
   } else {
     ret_val += 1;
   }
@@ -1139,6 +1415,15 @@ size_t TypeSupport<MembersType>::getEstimatedSerializedSize(
 template<typename MembersType>
 bool TypeSupport<MembersType>::serializeROSmessage(
   const void * ros_message, eprosima::fastcdr::Cdr & ser)
+{
+  rmw_fastrtps_shared_cpp::SerializationScratch scratch;
+  return serializeROSmessageWithScratch(ros_message, ser, scratch);
+}
+
+template<typename MembersType>
+bool TypeSupport<MembersType>::serializeROSmessageWithScratch(
+  const void * ros_message, eprosima::fastcdr::Cdr & ser,
+  rmw_fastrtps_shared_cpp::SerializationScratch & scratch)
 {
   assert(ros_message);
 
@@ -1146,7 +1431,9 @@ bool TypeSupport<MembersType>::serializeROSmessage(
   ser.serialize_encapsulation();
 
   if (members_->member_count_ != 0) {
-    TypeSupport::serializeROSmessage(ser, members_, ros_message);
+    // Alignment restarts after the encapsulation
+    size_t origin = ser.getSerializedDataLength();
+    TypeSupport::serializeROSmessage(ser, plan_, ros_message, origin, scratch);
   } else {
     ser << (uint8_t)0;
   }
@@ -1164,7 +1451,8 @@ bool TypeSupport<MembersType>::deserializeROSmessage(
   deser.read_encapsulation();
 
   if (members_->member_count_ != 0) {
-    TypeSupport::deserializeROSmessage(deser, members_, ros_message, false);
+    size_t origin = deser.getSerializedDataLength();
+    TypeSupport::deserializeROSmessage(deser, plan_, ros_message, origin, false);
   } else {
     uint8_t dump = 0;
     deser >> dump;
@@ -15,6 +15,8 @@
 #ifndef RMW_FASTRTPS_DYNAMIC_CPP__GET_PUBLISHER_HPP_
 #define RMW_FASTRTPS_DYNAMIC_CPP__GET_PUBLISHER_HPP_
 
+#include <cstdint>
+
 #include "fastrtps/publisher/Publisher.h"
 #include "rmw/rmw.h"
 #include "rmw_fastrtps_dynamic_cpp/visibility_control.h"
@@ -33,6 +35,22 @@ RMW_FASTRTPS_DYNAMIC_CPP_PUBLIC
 eprosima::fastrtps::Publisher *
 get_publisher(rmw_publisher_t * publisher);
 
+/// Return the number of heap allocations made so far to serialize the messages of a publisher.
+/**
+ * Only the temporaries the typesupport needs besides the message, like the
+ * buffer wide strings are converted into, are counted.
+ * They are reused from one message to the next, so the count stops increasing
+ * once they fit the messages being published.
+ *
+ * The function returns `0` when either the publisher handle is `NULL` or
+ * when the publisher handle is from a different rmw implementation.
+ *
+ * \return number of heap allocations made while serializing
+ */
+RMW_FASTRTPS_DYNAMIC_CPP_PUBLIC
+uint64_t
+get_serialization_allocation_count(rmw_publisher_t * publisher);
+
 }  // namespace rmw_fastrtps_dynamic_cpp
 
 #endif  // RMW_FASTRTPS_DYNAMIC_CPP__GET_PUBLISHER_HPP_
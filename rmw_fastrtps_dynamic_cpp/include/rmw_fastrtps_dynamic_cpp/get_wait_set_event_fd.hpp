@@ -0,0 +1,47 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_DYNAMIC_CPP__GET_WAIT_SET_EVENT_FD_HPP_
+#define RMW_FASTRTPS_DYNAMIC_CPP__GET_WAIT_SET_EVENT_FD_HPP_
+
+#include "rmw/rmw.h"
+#include "rmw_fastrtps_dynamic_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_dynamic_cpp
+{
+
+/// Return a file descriptor which becomes readable when the wait set may have ready entities.
+/**
+ * The descriptor can be added to an external event loop, e.g. with epoll.
+ * Once it is readable, call rmw_wait() with the same entities and a zero
+ * timeout to find out which of them are ready.
+ * The descriptor is only signaled when an entity receives something, an entity
+ * whose data was not all taken is reported by the next rmw_wait() without a signal.
+ * It is only available on Linux, for wait sets created while the
+ * `RMW_FASTRTPS_WAIT_SET_EVENTFD` environment variable is set to `1`.
+ * The wait set keeps ownership of the descriptor.
+ *
+ * The function returns `-1` when either the wait set handle is `NULL`, the
+ * wait set handle is from a different rmw implementation or the wait set has
+ * no event file descriptor.
+ *
+ * \return event file descriptor if successful, otherwise `-1`
+ */
+RMW_FASTRTPS_DYNAMIC_CPP_PUBLIC
+int
+get_wait_set_event_fd(rmw_wait_set_t * wait_set);
+
+}  // namespace rmw_fastrtps_dynamic_cpp
+
+#endif  // RMW_FASTRTPS_DYNAMIC_CPP__GET_WAIT_SET_EVENT_FD_HPP_
@@ -15,6 +15,7 @@
 #include "rmw_fastrtps_dynamic_cpp/get_client.hpp"
 
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_dynamic_cpp/identifier.hpp"
 
 namespace rmw_fastrtps_dynamic_cpp
@@ -46,4 +47,39 @@ get_response_subscriber(rmw_client_t * client)
   return impl->response_subscriber_;
 }
 
+uint64_t
+get_dropped_response_count(rmw_client_t * client)
+{
+  if (!client) {
+    return 0;
+  }
+  if (client->implementation_identifier != eprosima_fastrtps_identifier) {
+    return 0;
+  }
+  auto impl = static_cast<CustomClientInfo *>(client->data);
+  return impl->listener_->droppedResponses();
+}
+
+rmw_ret_t
+set_on_new_response_callback(
+  rmw_client_t * client,
+  void (* callback)(const void * user_data, size_t number_of_responses),
+  const void * user_data)
+{
+  return rmw_fastrtps_shared_cpp::__rmw_client_set_on_new_response_callback(
+    eprosima_fastrtps_identifier, client, callback, user_data);
+}
+
+rmw_ret_t
+take_response_for(
+  const rmw_client_t * client,
+  int64_t sequence_id,
+  rmw_request_id_t * request_header,
+  void * ros_response,
+  bool * taken)
+{
+  return rmw_fastrtps_shared_cpp::__rmw_take_response_for(
+    eprosima_fastrtps_identifier, client, sequence_id, request_header, ros_response, taken);
+}
+
 }  // namespace rmw_fastrtps_dynamic_cpp
@@ -33,4 +33,17 @@ get_publisher(rmw_publisher_t * publisher)
   return impl->publisher_;
 }
 
+uint64_t
+get_serialization_allocation_count(rmw_publisher_t * publisher)
+{
+  if (!publisher) {
+    return 0;
+  }
+  if (publisher->implementation_identifier != eprosima_fastrtps_identifier) {
+    return 0;
+  }
+  auto impl = static_cast<CustomPublisherInfo *>(publisher->data);
+  return impl->serialization_scratch_.allocation_count();
+}
+
 }  // namespace rmw_fastrtps_dynamic_cpp
@@ -46,4 +46,17 @@ get_response_publisher(rmw_service_t * service)
   return impl->response_publisher_;
 }
 
+uint64_t
+get_dropped_request_count(rmw_service_t * service)
+{
+  if (!service) {
+    return 0;
+  }
+  if (service->implementation_identifier != eprosima_fastrtps_identifier) {
+    return 0;
+  }
+  auto impl = static_cast<CustomServiceInfo *>(service->data);
+  return impl->listener_->droppedRequests();
+}
+
 }  // namespace rmw_fastrtps_dynamic_cpp
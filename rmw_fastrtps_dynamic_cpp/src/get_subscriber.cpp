@@ -15,6 +15,7 @@
 #include "rmw_fastrtps_dynamic_cpp/get_subscriber.hpp"
 
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_dynamic_cpp/identifier.hpp"
 
 namespace rmw_fastrtps_dynamic_cpp
@@ -33,4 +34,18 @@ get_subscriber(rmw_subscription_t * subscription)
   return impl->subscriber_;
 }
 
+rmw_ret_t
+take_sequence(
+  const rmw_subscription_t * subscription,
+  size_t count,
+  void * const * ros_messages,
+  rmw_message_info_t * message_infos,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation)
+{
+  return rmw_fastrtps_shared_cpp::__rmw_take_sequence(
+    eprosima_fastrtps_identifier, subscription, count, ros_messages, message_infos, taken,
+    allocation);
+}
+
 }  // namespace rmw_fastrtps_dynamic_cpp
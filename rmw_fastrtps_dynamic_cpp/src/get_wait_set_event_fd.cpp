@@ -0,0 +1,41 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_dynamic_cpp/get_wait_set_event_fd.hpp"
+
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_dynamic_cpp/identifier.hpp"
+
+namespace rmw_fastrtps_dynamic_cpp
+{
+
+int
+get_wait_set_event_fd(rmw_wait_set_t * wait_set)
+{
+  if (!wait_set) {
+    return -1;
+  }
+  if (wait_set->implementation_identifier != eprosima_fastrtps_identifier) {
+    return -1;
+  }
+  int fd = -1;
+  if (rmw_fastrtps_shared_cpp::__rmw_get_wait_set_event_fd(
+      eprosima_fastrtps_identifier, wait_set, &fd) != RMW_RET_OK)
+  {
+    return -1;
+  }
+  return fd;
+}
+
+}  // namespace rmw_fastrtps_dynamic_cpp
@@ -100,6 +100,8 @@ rmw_create_client(
   info->typesupport_identifier_ = type_support->typesupport_identifier;
   info->request_publisher_matched_count_ = 0;
   info->response_subscriber_matched_count_ = 0;
+  info->server_available_ = false;
+  info->graph_guard_condition_ = impl->graph_guard_condition;
 
   const void * untyped_request_members;
   const void * untyped_response_members;
@@ -167,7 +169,7 @@ rmw_create_client(
     RMW_SET_ERROR_MSG("failed to get datareader qos");
     goto fail;
   }
-  info->listener_ = new ClientListener(info);
+  info->listener_ = new ClientListener(info, subscriberParam.topic.historyQos);
   info->response_subscriber_ =
     Domain::createSubscriber(participant, subscriberParam, info->listener_);
   if (!info->response_subscriber_) {
@@ -0,0 +1,43 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INTROSPECTION_HELPERS_HPP_
+#define INTROSPECTION_HELPERS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rosidl_generator_c/message_type_support_struct.h"
+
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+// Fill in the member of a hand written introspection, of the C++ flavour unless told otherwise
+template<typename MemberT = rosidl_typesupport_introspection_cpp::MessageMember>
+MemberT
+make_member(
+  const char * name, uint8_t type_id, size_t offset,
+  const rosidl_message_type_support_t * members = nullptr,
+  bool is_array = false, size_t array_size = 0)
+{
+  MemberT member{};
+  member.name_ = name;
+  member.type_id_ = type_id;
+  member.members_ = members;
+  member.is_array_ = is_array;
+  member.array_size_ = array_size;
+  member.offset_ = static_cast<uint32_t>(offset);
+  return member;
+}
+
+#endif  // INTROSPECTION_HELPERS_HPP_
@@ -0,0 +1,375 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "fastcdr/Cdr.h"
+#include "fastcdr/FastBuffer.h"
+
+#include "rosidl_typesupport_introspection_cpp/field_types.hpp"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+#include "rmw_fastrtps_dynamic_cpp/TypeSupport.hpp"
+
+#include "./introspection_helpers.hpp"
+
+using eprosima::fastcdr::Cdr;
+using eprosima::fastcdr::FastBuffer;
+using rosidl_typesupport_introspection_cpp::MessageMember;
+using rosidl_typesupport_introspection_cpp::MessageMembers;
+
+namespace
+{
+struct Pod
+{
+  int32_t x;
+  int32_t y;
+  uint8_t z;
+};
+
+struct Inner
+{
+  uint8_t a;
+  double b;
+  int32_t c;
+  std::array<int16_t, 3> shorts;
+  std::string s;
+};
+
+struct Grid
+{
+  std::array<Pod, 2> row;
+  std::vector<Pod> extra;
+};
+
+struct Message
+{
+  // Aligned relative to the end of the encapsulation
+  uint8_t first;
+  double after_first;
+  // Never part of a run of primitive members
+  bool flag;
+  uint8_t u8;
+  int16_t i16;
+  int32_t i32;
+  // Shifts the stream position of everything after it
+  std::string name;
+  int32_t x;
+  int32_t y;
+  double d;
+  std::array<float, 3> floats;
+  bool flag2;
+  uint16_t u16;
+  Pod pod;
+  std::array<Grid, 2> grids;
+  std::vector<Inner> inners;
+  std::array<bool, 3> bools;
+  std::vector<double> doubles;
+};
+
+// Introspection of Message, written by hand like rosidl would generate it
+class MessageIntrospection
+{
+public:
+  MessageIntrospection()
+  {
+    namespace ti = rosidl_typesupport_introspection_cpp;
+
+    pod_members_ = {
+      make_member("x", ti::ROS_TYPE_INT32, offsetof(Pod, x)),
+      make_member("y", ti::ROS_TYPE_INT32, offsetof(Pod, y)),
+      make_member("z", ti::ROS_TYPE_UINT8, offsetof(Pod, z)),
+    };
+    set_members(pod_, pod_type_support_, "Pod", sizeof(Pod), pod_members_);
+
+    inner_members_ = {
+      make_member("a", ti::ROS_TYPE_UINT8, offsetof(Inner, a)),
+      make_member("b", ti::ROS_TYPE_FLOAT64, offsetof(Inner, b)),
+      make_member("c", ti::ROS_TYPE_INT32, offsetof(Inner, c)),
+      make_member("shorts", ti::ROS_TYPE_INT16, offsetof(Inner, shorts), nullptr, true, 3),
+      make_member("s", ti::ROS_TYPE_STRING, offsetof(Inner, s)),
+    };
+    set_members(inner_, inner_type_support_, "Inner", sizeof(Inner), inner_members_);
+
+    grid_members_ = {
+      make_member("row", ti::ROS_TYPE_MESSAGE, offsetof(Grid, row), &pod_type_support_, true, 2),
+      make_member(
+        "extra", ti::ROS_TYPE_MESSAGE, offsetof(Grid, extra), &pod_type_support_, true),
+    };
+    set_members(grid_, grid_type_support_, "Grid", sizeof(Grid), grid_members_);
+
+    message_members_ = {
+      make_member("first", ti::ROS_TYPE_UINT8, offsetof(Message, first)),
+      make_member("after_first", ti::ROS_TYPE_FLOAT64, offsetof(Message, after_first)),
+      make_member("flag", ti::ROS_TYPE_BOOL, offsetof(Message, flag)),
+      make_member("u8", ti::ROS_TYPE_UINT8, offsetof(Message, u8)),
+      make_member("i16", ti::ROS_TYPE_INT16, offsetof(Message, i16)),
+      make_member("i32", ti::ROS_TYPE_INT32, offsetof(Message, i32)),
+      make_member("name", ti::ROS_TYPE_STRING, offsetof(Message, name)),
+      make_member("x", ti::ROS_TYPE_INT32, offsetof(Message, x)),
+      make_member("y", ti::ROS_TYPE_INT32, offsetof(Message, y)),
+      make_member("d", ti::ROS_TYPE_FLOAT64, offsetof(Message, d)),
+      make_member("floats", ti::ROS_TYPE_FLOAT32, offsetof(Message, floats), nullptr, true, 3),
+      make_member("flag2", ti::ROS_TYPE_BOOL, offsetof(Message, flag2)),
+      make_member("u16", ti::ROS_TYPE_UINT16, offsetof(Message, u16)),
+      make_member("pod", ti::ROS_TYPE_MESSAGE, offsetof(Message, pod), &pod_type_support_),
+      make_member(
+        "grids", ti::ROS_TYPE_MESSAGE, offsetof(Message, grids), &grid_type_support_, true, 2),
+      make_member(
+        "inners", ti::ROS_TYPE_MESSAGE, offsetof(Message, inners), &inner_type_support_, true),
+      make_member("bools", ti::ROS_TYPE_BOOL, offsetof(Message, bools), nullptr, true, 3),
+      make_member("doubles", ti::ROS_TYPE_FLOAT64, offsetof(Message, doubles), nullptr, true),
+    };
+    set_members(message_, message_type_support_, "Message", sizeof(Message), message_members_);
+  }
+
+  const MessageMembers *
+  members() const
+  {
+    return &message_;
+  }
+
+private:
+  static void
+  set_members(
+    MessageMembers & members, rosidl_message_type_support_t & type_support,
+    const char * name, size_t size_of, const std::vector<MessageMember> & member_list)
+  {
+    members = MessageMembers{};
+    members.message_namespace_ = "test_msgs::msg";
+    members.message_name_ = name;
+    members.member_count_ = static_cast<uint32_t>(member_list.size());
+    members.size_of_ = size_of;
+    members.members_ = member_list.data();
+    type_support = rosidl_message_type_support_t{};
+    type_support.typesupport_identifier =
+      rosidl_typesupport_introspection_cpp::typesupport_identifier;
+    type_support.data = &members;
+  }
+
+  std::vector<MessageMember> pod_members_;
+  std::vector<MessageMember> inner_members_;
+  std::vector<MessageMember> grid_members_;
+  std::vector<MessageMember> message_members_;
+  MessageMembers pod_;
+  MessageMembers inner_;
+  MessageMembers grid_;
+  MessageMembers message_;
+  rosidl_message_type_support_t pod_type_support_;
+  rosidl_message_type_support_t inner_type_support_;
+  rosidl_message_type_support_t grid_type_support_;
+  rosidl_message_type_support_t message_type_support_;
+};
+
+// Serializes with runs of primitive members copied as blocks, or every member on its own
+class PlanTypeSupport : public rmw_fastrtps_dynamic_cpp::TypeSupport<MessageMembers>
+{
+public:
+  PlanTypeSupport(const MessageMembers * members, bool merge_pod_runs)
+  {
+    members_ = members;
+    compileSerializationPlan(merge_pod_runs);
+  }
+};
+
+Pod
+make_pod(int32_t value)
+{
+  return Pod{value, -value, static_cast<uint8_t>(value)};
+}
+
+void
+fill(Message & message)
+{
+  message.first = 0x11;
+  message.after_first = 1.5;
+  message.flag = true;
+  message.u8 = 0x22;
+  message.i16 = -3;
+  message.i32 = 400000;
+  message.x = 5;
+  message.y = -6;
+  message.d = 7.25;
+  message.floats = {{8.f, 9.f, 10.f}};
+  message.flag2 = false;
+  message.u16 = 0xabcd;
+  message.pod = make_pod(11);
+  for (size_t i = 0; i < message.grids.size(); ++i) {
+    Grid & grid = message.grids[i];
+    grid.row = {{make_pod(20 + static_cast<int32_t>(i)), make_pod(30)}};
+    grid.extra.assign(i + 1, make_pod(40 + static_cast<int32_t>(i)));
+  }
+  message.inners.resize(3);
+  for (size_t i = 0; i < message.inners.size(); ++i) {
+    Inner & inner = message.inners[i];
+    inner.a = static_cast<uint8_t>(i);
+    inner.b = 0.5 * static_cast<double>(i);
+    inner.c = -static_cast<int32_t>(i);
+    inner.shorts = {{1, 2, static_cast<int16_t>(i)}};
+    inner.s.assign(i, 's');
+  }
+  message.bools = {{true, false, true}};
+  message.doubles = {1.0, 2.0, 3.0};
+}
+
+// Padding is left as is by Fast-CDR, while runs of primitive members are copied along with
+// the padding between them in the message. Both are zero in the zeroed buffer and in a
+// ZeroedMessage, so that the outputs are comparable byte for byte.
+class ZeroedMessage
+{
+public:
+  ZeroedMessage()
+  {
+    memset(&storage_, 0, sizeof(storage_));
+    message_ = new (&storage_) Message();
+  }
+
+  ~ZeroedMessage()
+  {
+    message_->~Message();
+  }
+
+  Message &
+  operator*()
+  {
+    return *message_;
+  }
+
+private:
+  std::aligned_storage<sizeof(Message), alignof(Message)>::type storage_;
+  Message * message_;
+};
+
+std::vector<char>
+serialize(PlanTypeSupport & type_support, const Message & message, Cdr::Endianness endianness)
+{
+  std::vector<char> bytes(1 << 12, 0);
+  FastBuffer buffer(bytes.data(), bytes.size());
+  Cdr ser(buffer, endianness, Cdr::DDS_CDR);
+  EXPECT_TRUE(type_support.serializeROSmessage(&message, ser));
+  bytes.resize(ser.getSerializedDataLength());
+  return bytes;
+}
+
+void
+deserialize(PlanTypeSupport & type_support, std::vector<char> & bytes, Message & message)
+{
+  FastBuffer buffer(bytes.data(), bytes.size());
+  Cdr deser(buffer, Cdr::DEFAULT_ENDIAN, Cdr::DDS_CDR);
+  EXPECT_TRUE(type_support.deserializeROSmessage(deser, &message));
+}
+
+const Cdr::Endianness endiannesses[] = {Cdr::LITTLE_ENDIANNESS, Cdr::BIG_ENDIANNESS};
+}  // namespace
+
+TEST(SerializationPlanTest, test_plan_matches_field_by_field) {
+  MessageIntrospection introspection;
+  PlanTypeSupport plan(introspection.members(), true);
+  PlanTypeSupport field_by_field(introspection.members(), false);
+
+  ZeroedMessage zeroed;
+  Message & message = *zeroed;
+  fill(message);
+  // Every stream position modulo the largest alignment in front of the runs after name
+  for (size_t length = 0; length < 9; ++length) {
+    message.name.assign(length, 'n');
+    for (Cdr::Endianness endianness : endiannesses) {
+      std::vector<char> expected = serialize(field_by_field, message, endianness);
+      std::vector<char> actual = serialize(plan, message, endianness);
+      EXPECT_EQ(actual, expected) << "name of " << length << " characters";
+    }
+  }
+}
+
+TEST(SerializationPlanTest, test_round_trip) {
+  MessageIntrospection introspection;
+  PlanTypeSupport plan(introspection.members(), true);
+  PlanTypeSupport field_by_field(introspection.members(), false);
+
+  ZeroedMessage zeroed;
+  Message & message = *zeroed;
+  fill(message);
+  for (size_t length = 0; length < 9; ++length) {
+    message.name.assign(length, 'n');
+    for (Cdr::Endianness endianness : endiannesses) {
+      std::vector<char> bytes = serialize(plan, message, endianness);
+
+      Message with_plan;
+      deserialize(plan, bytes, with_plan);
+      Message without_plan;
+      deserialize(field_by_field, bytes, without_plan);
+
+      EXPECT_EQ(serialize(field_by_field, with_plan, endianness), bytes);
+      EXPECT_EQ(serialize(field_by_field, without_plan, endianness), bytes);
+      EXPECT_EQ(with_plan.name, message.name);
+      EXPECT_EQ(with_plan.grids[1].extra.size(), 2u);
+      EXPECT_EQ(with_plan.grids[1].row[0].x, 21);
+      EXPECT_EQ(with_plan.inners[2].shorts[2], 2);
+      EXPECT_EQ(with_plan.inners[2].s, "ss");
+      EXPECT_EQ(with_plan.doubles, message.doubles);
+    }
+  }
+}
+
+TEST(SerializationPlanTest, test_bools_are_not_copied_as_is) {
+  MessageIntrospection introspection;
+  PlanTypeSupport plan(introspection.members(), true);
+  PlanTypeSupport field_by_field(introspection.members(), false);
+
+  ZeroedMessage zeroed;
+  Message & message = *zeroed;
+  fill(message);
+  // Like an uninitialized bool, which must still be sent as 1
+  const uint8_t not_zero_or_one = 2;
+  memcpy(&message.flag, &not_zero_or_one, 1);
+
+  std::vector<char> bytes = serialize(plan, message, Cdr::DEFAULT_ENDIAN);
+  EXPECT_EQ(bytes, serialize(field_by_field, message, Cdr::DEFAULT_ENDIAN));
+  // 4 bytes of encapsulation, first, 7 bytes of padding and after_first
+  ASSERT_GT(bytes.size(), 20u);
+  EXPECT_EQ(bytes[20], 1);
+
+  Message taken;
+  deserialize(plan, bytes, taken);
+  EXPECT_TRUE(taken.flag);
+  EXPECT_EQ(taken.u8, message.u8);
+}
+
+TEST(SerializationPlanTest, test_alignment_restarts_after_encapsulation) {
+  MessageIntrospection introspection;
+  PlanTypeSupport plan(introspection.members(), true);
+
+  ZeroedMessage zeroed;
+  Message & message = *zeroed;
+  fill(message);
+  std::vector<char> bytes = serialize(plan, message, Cdr::LITTLE_ENDIANNESS);
+
+  ASSERT_GT(bytes.size(), 20u);
+  EXPECT_EQ(bytes[4], 0x11);
+  // Aligned to 8 bytes from the end of the encapsulation, not from the start of the buffer
+  for (size_t i = 5; i < 12; ++i) {
+    EXPECT_EQ(bytes[i], 0) << "padding byte " << i;
+  }
+  double after_first = 0.0;
+  memcpy(&after_first, &bytes[12], sizeof(after_first));
+  EXPECT_EQ(after_first, message.after_first);
+}
@@ -0,0 +1,182 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "fastrtps/rtps/common/SerializedPayload.h"
+
+#include "rosidl_typesupport_introspection_c/field_types.h"
+#include "rosidl_typesupport_introspection_c/message_introspection.h"
+
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_dynamic_cpp/MessageTypeSupport.hpp"
+
+#include "./introspection_helpers.hpp"
+
+using rmw_fastrtps_shared_cpp::SerializationScratch;
+using rmw_fastrtps_shared_cpp::SerializedData;
+
+namespace
+{
+struct Message
+{
+  rosidl_generator_c__String name;
+  rosidl_generator_c__U16String label;
+  rosidl_generator_c__String__Sequence tags;
+  rosidl_generator_c__U16String__Sequence notes;
+};
+
+// Message made mostly of strings and wide strings, whose length can be changed between publishes
+class StringMessage
+{
+public:
+  static constexpr size_t kMaxLength = 256;
+  static constexpr size_t kSequenceSize = 4;
+
+  StringMessage()
+  : chars_(kMaxLength + 1, 'c'), wchars_(kMaxLength + 1, u'w'),
+    tags_(kSequenceSize), notes_(kSequenceSize)
+  {
+    members_.push_back(
+      make_member<rosidl_typesupport_introspection_c__MessageMember>(
+        "name", rosidl_typesupport_introspection_c__ROS_TYPE_STRING,
+        offsetof(Message, name), nullptr, false));
+    members_.push_back(
+      make_member<rosidl_typesupport_introspection_c__MessageMember>(
+        "label", rosidl_typesupport_introspection_c__ROS_TYPE_WSTRING,
+        offsetof(Message, label), nullptr, false));
+    members_.push_back(
+      make_member<rosidl_typesupport_introspection_c__MessageMember>(
+        "tags", rosidl_typesupport_introspection_c__ROS_TYPE_STRING,
+        offsetof(Message, tags), nullptr, true));
+    members_.push_back(
+      make_member<rosidl_typesupport_introspection_c__MessageMember>(
+        "notes", rosidl_typesupport_introspection_c__ROS_TYPE_WSTRING,
+        offsetof(Message, notes), nullptr, true));
+    introspection = rosidl_typesupport_introspection_c__MessageMembers{};
+    introspection.message_namespace_ = "test_msgs__msg";
+    introspection.message_name_ = "Strings";
+    introspection.member_count_ = static_cast<uint32_t>(members_.size());
+    introspection.size_of_ = sizeof(Message);
+    introspection.members_ = members_.data();
+
+    message = Message{};
+    message.tags.data = tags_.data();
+    message.tags.size = message.tags.capacity = tags_.size();
+    message.notes.data = notes_.data();
+    message.notes.size = message.notes.capacity = notes_.size();
+    set_length(0);
+  }
+
+  // Make every string of the message `length` characters long.
+  void
+  set_length(size_t length)
+  {
+    chars_.assign(kMaxLength + 1, 'c');
+    chars_[length] = '\0';
+    set_string(message.name, length);
+    set_wstring(message.label, length);
+    for (size_t i = 0; i < kSequenceSize; ++i) {
+      set_string(tags_[i], length);
+      set_wstring(notes_[i], length);
+    }
+  }
+
+  rosidl_typesupport_introspection_c__MessageMembers introspection;
+  Message message;
+
+private:
+  void
+  set_string(rosidl_generator_c__String & string, size_t length)
+  {
+    string.data = &chars_[0];
+    string.size = length;
+    string.capacity = kMaxLength + 1;
+  }
+
+  void
+  set_wstring(rosidl_generator_c__U16String & string, size_t length)
+  {
+    string.data = reinterpret_cast<uint16_t *>(&wchars_[0]);
+    string.size = length;
+    string.capacity = kMaxLength + 1;
+  }
+
+  std::vector<rosidl_typesupport_introspection_c__MessageMember> members_;
+  std::string chars_;
+  std::u16string wchars_;
+  std::vector<rosidl_generator_c__String> tags_;
+  std::vector<rosidl_generator_c__U16String> notes_;
+};
+
+// Serialize `message` the way rmw_publish() does, with the scratch of the publisher.
+bool
+publish(
+  rmw_fastrtps_shared_cpp::TypeSupport & type_support, void * message,
+  SerializationScratch & scratch)
+{
+  SerializedData data;
+  data.is_cdr_buffer = false;
+  data.data = message;
+  data.scratch = &scratch;
+  eprosima::fastrtps::rtps::SerializedPayload_t payload(1 << 16);
+  return type_support.serialize(&data, &payload) && payload.length > 0;
+}
+}  // namespace
+
+using CMessageTypeSupport =
+  rmw_fastrtps_dynamic_cpp::MessageTypeSupport<rosidl_typesupport_introspection_c__MessageMembers>;
+
+TEST(SerializationScratchTest, test_steady_state_does_not_allocate) {
+  StringMessage strings;
+  CMessageTypeSupport type_support(&strings.introspection);
+  SerializationScratch scratch;
+
+  strings.set_length(StringMessage::kMaxLength);
+  ASSERT_TRUE(publish(type_support, &strings.message, scratch));
+  uint64_t allocations = scratch.allocation_count();
+  EXPECT_GT(allocations, 0u);
+
+  for (size_t i = 0; i < 1000; ++i) {
+    strings.set_length(i % (StringMessage::kMaxLength + 1));
+    ASSERT_TRUE(publish(type_support, &strings.message, scratch));
+  }
+  EXPECT_EQ(scratch.allocation_count(), allocations);
+}
+
+TEST(SerializationScratchTest, test_allocates_only_when_strings_get_longer) {
+  StringMessage strings;
+  CMessageTypeSupport type_support(&strings.introspection);
+  SerializationScratch scratch;
+
+  strings.set_length(8);
+  ASSERT_TRUE(publish(type_support, &strings.message, scratch));
+  uint64_t short_allocations = scratch.allocation_count();
+  for (size_t i = 0; i < 100; ++i) {
+    ASSERT_TRUE(publish(type_support, &strings.message, scratch));
+  }
+  EXPECT_EQ(scratch.allocation_count(), short_allocations);
+
+  strings.set_length(StringMessage::kMaxLength);
+  ASSERT_TRUE(publish(type_support, &strings.message, scratch));
+  uint64_t long_allocations = scratch.allocation_count();
+  EXPECT_GT(long_allocations, short_allocations);
+  for (size_t i = 0; i < 100; ++i) {
+    ASSERT_TRUE(publish(type_support, &strings.message, scratch));
+  }
+  EXPECT_EQ(scratch.allocation_count(), long_allocations);
+}
@@ -25,6 +25,9 @@
 
 #include "rcutils/logging_macros.h"
 
+#include "rmw/types.h"
+
+#include "./serialization_scratch.hpp"
 #include "./visibility_control.h"
 
 namespace rmw_fastrtps_shared_cpp
@@ -34,7 +37,15 @@ namespace rmw_fastrtps_shared_cpp
 struct SerializedData
 {
   bool is_cdr_buffer;  // Whether next field is a pointer to a Cdr or to a plain ros message
-  void * data;
+  void * data;  // A null buffer when is_cdr_buffer is true discards the sample
+  // Whether data is an rmw_serialized_message_t instead of a FastBuffer, when taking
+  bool is_serialized_message = false;
+  // Result of resizing that rmw_serialized_message_t, when it was too small
+  rmw_ret_t serialized_message_ret = RMW_RET_OK;
+  // Length of the payload copied into the FastBuffer, which may be larger when recycled
+  size_t length = 0;
+  // Temporaries of the publisher writing a plain ros message, if any
+  SerializationScratch * scratch = nullptr;
 };
 
 class TypeSupport : public eprosima::fastrtps::TopicDataType
@@ -44,6 +55,11 @@ public:
 
   virtual bool serializeROSmessage(const void * ros_message, eprosima::fastcdr::Cdr & ser) = 0;
 
+  // Same as serializeROSmessage(), taking any temporaries it needs from scratch.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  virtual bool serializeROSmessageWithScratch(
+    const void * ros_message, eprosima::fastcdr::Cdr & ser, SerializationScratch & scratch);
+
   virtual bool deserializeROSmessage(eprosima::fastcdr::Cdr & deser, void * ros_message) = 0;
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
@@ -74,6 +90,12 @@ public:
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   virtual ~TypeSupport() {}
 
+  // Whether no message of the type is larger than m_typeSize
+  bool isBounded() const
+  {
+    return max_size_bound_;
+  }
+
 protected:
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   TypeSupport();
@@ -0,0 +1,169 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__BOUNDED_QUEUE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__BOUNDED_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Fixed capacity, lock-free, multi-producer multi-consumer FIFO queue.
+/**
+ * All the storage is allocated upfront, pushing and popping never allocate.
+ * The capacity is rounded up to a power of two.
+ *
+ * Any thread may push() and pop() concurrently, without any lock.
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+  explicit BoundedQueue(size_t capacity)
+  {
+    enqueue_pos_.value.store(0, std::memory_order_relaxed);
+    dequeue_pos_.value.store(0, std::memory_order_relaxed);
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    cells_.reset(new Cell[size]);
+    mask_ = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue & operator=(const BoundedQueue &) = delete;
+
+  /// Append `value` to the queue.
+  /**
+   * \return `false` if the queue is full, `value` is left untouched then.
+   */
+  bool
+  push(T && value)
+  {
+    size_t pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+    Cell * cell;
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool
+  push(const T & value)
+  {
+    T copy(value);
+    return push(std::move(copy));
+  }
+
+  /// Take the oldest element of the queue.
+  /**
+   * \return `false` if the queue is empty.
+   */
+  bool
+  pop(T & value)
+  {
+    size_t pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+    Cell * cell;
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(cell->value);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Whether the queue is empty, exact only when no push() or pop() is in progress.
+  bool
+  empty() const
+  {
+    return dequeue_pos_.value.load(std::memory_order_acquire) ==
+           enqueue_pos_.value.load(std::memory_order_acquire);
+  }
+
+  /// Number of queued elements, exact only when no push() or pop() is in progress.
+  size_t
+  size() const
+  {
+    size_t dequeue_pos = dequeue_pos_.value.load(std::memory_order_acquire);
+    size_t enqueue_pos = enqueue_pos_.value.load(std::memory_order_acquire);
+    return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+  }
+
+  size_t
+  capacity() const
+  {
+    return mask_ + 1;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic_size_t sequence;
+    T value;
+  };
+
+  // Assumed size of a cache line, the padding only needs to be at least that large
+  static constexpr size_t kCacheLineSize = 64;
+
+  // Position alone on its cache line, producers and consumers each update
+  // their own without invalidating the other one or the fields read by both.
+  struct Position
+  {
+    char pad_before[kCacheLineSize];
+    std::atomic_size_t value;
+    char pad_after[kCacheLineSize - sizeof(std::atomic_size_t)];
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  Position enqueue_pos_;
+  Position dequeue_pos_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__BOUNDED_QUEUE_HPP_
@@ -15,13 +15,13 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_CLIENT_INFO_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_CLIENT_INFO_HPP_
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
-#include <list>
-#include <memory>
 #include <mutex>
 #include <set>
-#include <utility>
+#include <thread>
+#include <vector>
 
 #include "fastcdr/FastBuffer.h"
 
@@ -31,10 +31,18 @@
 #include "fastrtps/participant/Participant.h"
 #include "fastrtps/publisher/Publisher.h"
 #include "fastrtps/publisher/PublisherListener.h"
+#include "fastrtps/qos/QosPolicies.h"
 
 #include "rcpputils/thread_safety_annotations.hpp"
 
+#include "rmw/rmw.h"
+
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/bounded_queue.hpp"
+#include "rmw_fastrtps_shared_cpp/fast_buffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/parked_queue.hpp"
+#include "rmw_fastrtps_shared_cpp/ready_queue.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
 class ClientListener;
 class ClientPubListener;
@@ -52,92 +60,304 @@ typedef struct CustomClientInfo
   ClientPubListener * pub_listener_;
   std::atomic_size_t response_subscriber_matched_count_;
   std::atomic_size_t request_publisher_matched_count_;
+  // Whether both matched counts are non zero, read by rmw_service_server_is_available()
+  std::atomic_bool server_available_;
+  std::mutex server_available_mutex_;
+  // Graph guard condition of the node, triggered when server_available_ changes
+  rmw_guard_condition_t * graph_guard_condition_;
 } CustomClientInfo;
 
+/// Update whether the service server is available after a matched count changed.
+/**
+ * A client has a server once its request publisher and its response
+ * subscriber are both matched.
+ * When this changes, the graph guard condition of the node is triggered, so
+ * clients waiting for the service wake up as soon as it can be called.
+ */
+inline void
+update_server_available(CustomClientInfo * info)
+{
+  {
+    // Serializes the updates from the two listeners, so the last one sees both counts
+    std::lock_guard<std::mutex> lock(info->server_available_mutex_);
+    bool available = info->request_publisher_matched_count_.load() > 0 &&
+      info->response_subscriber_matched_count_.load() > 0;
+    if (info->server_available_.exchange(available) == available) {
+      return;
+    }
+  }
+  if (info->graph_guard_condition_ != nullptr) {
+    rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
+      info->graph_guard_condition_->implementation_identifier,
+      info->graph_guard_condition_);
+  }
+}
+
 typedef struct CustomClientResponse
 {
   eprosima::fastrtps::rtps::SampleIdentity sample_identity_;
-  std::unique_ptr<eprosima::fastcdr::FastBuffer> buffer_;
+  eprosima::fastcdr::FastBuffer * buffer_;
+  // Length of the response in buffer_, the rest of it is left over from earlier responses
+  size_t length_;
+
+  CustomClientResponse()
+  : buffer_(nullptr), length_(0) {}
 } CustomClientResponse;
 
 class ClientListener : public eprosima::fastrtps::SubscriberListener
 {
 public:
-  explicit ClientListener(CustomClientInfo * info)
-  : info_(info), list_has_data_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr) {}
+  using ResponseCallback = void (*)(const void * user_data, size_t number_of_responses);
+
+  // Responses received but not taken yet by a KEEP_ALL client, beyond which they are parked
+  static constexpr size_t kResponseQueueCapacity = 1024;
+  // Idle response buffers kept for reuse, clients seldom wait for many responses at once
+  static constexpr size_t kBufferPoolCapacity = 8;
+
+  /// Listener queueing at most as many responses as the `history` of the response reader.
+  /**
+   * With KEEP_LAST, the oldest response is dropped to make room for a new one
+   * once `depth` responses are waiting.
+   * With KEEP_ALL, no response is dropped: beyond kResponseQueueCapacity the
+   * queued responses and the new ones are parked, as getResponseFor() does.
+   */
+  ClientListener(CustomClientInfo * info, const eprosima::fastrtps::HistoryQosPolicy & history)
+  : info_(info), keep_last_(eprosima::fastrtps::KEEP_LAST_HISTORY_QOS == history.kind),
+    depth_(keep_last_ ? std::max<size_t>(history.depth, 1) : kResponseQueueCapacity),
+    responses_(depth_), buffer_pool_(kBufferPoolCapacity), discarded_responses_(0),
+    dropped_responses_(0), parked_(depth_), parked_count_(0), responseCallback_(nullptr),
+    callbackUserData_(nullptr), callbackGeneration_(0), conditionMutex_(nullptr),
+    conditionVariable_(nullptr), readyQueue_(nullptr), readyToken_(0)
+  {
+  }
 
+  ~ClientListener()
+  {
+    CustomClientResponse response;
+    while (getResponse(response)) {
+      buffer_pool_.release(response.buffer_);
+    }
+  }
 
   void
   onNewDataMessage(eprosima::fastrtps::Subscriber * sub)
   {
     assert(sub);
 
-    CustomClientResponse response;
-    // Todo(sloretz) eliminate heap allocation pending eprosima/Fast-CDR#19
-    response.buffer_.reset(new eprosima::fastcdr::FastBuffer());
     eprosima::fastrtps::SampleInfo_t sinfo;
-
     rmw_fastrtps_shared_cpp::SerializedData data;
     data.is_cdr_buffer = true;
-    data.data = response.buffer_.get();
-    if (sub->takeNextData(&data, &sinfo)) {
-      if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
-        response.sample_identity_ = sinfo.related_sample_identity;
-
-        if (response.sample_identity_.writer_guid() == info_->writer_guid_) {
-          std::lock_guard<std::mutex> lock(internalMutex_);
-
-          if (conditionMutex_ != nullptr) {
-            std::unique_lock<std::mutex> clock(*conditionMutex_);
-            list.emplace_back(std::move(response));
-            // the change to list_has_data_ needs to be mutually exclusive with
-            // rmw_wait() which checks hasData() and decides if wait() needs to
-            // be called
-            list_has_data_.store(true);
-            clock.unlock();
-            conditionVariable_->notify_one();
-          } else {
-            list.emplace_back(std::move(response));
-            list_has_data_.store(true);
-          }
+
+    // All the clients of a service read the same response topic, the responses to
+    // the requests of the other clients are discarded without being copied.
+    if (sub->get_first_untaken_info(&sinfo) &&
+      eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind &&
+      sinfo.related_sample_identity.writer_guid() != info_->writer_guid_)
+    {
+      data.data = nullptr;
+      if (sub->takeNextData(&data, &sinfo)) {
+        discarded_responses_.fetch_add(1, std::memory_order_relaxed);
+      }
+      return;
+    }
+
+    CustomClientResponse response;
+    response.buffer_ = buffer_pool_.acquire();
+    if (response.buffer_ == nullptr) {
+      return;
+    }
+    data.data = response.buffer_;
+    if (!sub->takeNextData(&data, &sinfo) ||
+      eprosima::fastrtps::rtps::ALIVE != sinfo.sampleKind ||
+      sinfo.related_sample_identity.writer_guid() != info_->writer_guid_)
+    {
+      buffer_pool_.release(response.buffer_);
+      return;
+    }
+    response.sample_identity_ = sinfo.related_sample_identity;
+    response.length_ = data.length;
+
+    std::unique_lock<std::mutex> callback_lock(callbackMutex_, std::defer_lock);
+    {
+      std::lock_guard<std::mutex> lock(internalMutex_);
+
+      if (conditionMutex_ != nullptr) {
+        std::unique_lock<std::mutex> clock(*conditionMutex_);
+        // the push needs to be mutually exclusive with rmw_wait() which checks
+        // hasData() and decides if wait() needs to be called
+        if (!queueResponse(response)) {
+          return;
+        }
+        if (readyQueue_ != nullptr) {
+          readyQueue_->push(readyToken_);
         }
+        clock.unlock();
+        conditionVariable_->notify_one();
+      } else if (!queueResponse(response)) {
+        return;
       }
+      // Before setResponseCallback() can count the response, so it is reported exactly once
+      callback_lock.lock();
+    }
+
+    if (responseCallback_ != nullptr) {
+      runCallback(callback_lock, responseCallback_, callbackUserData_, callbackGeneration_, 1);
+    }
+  }
+
+  /// Set the function called from the middleware thread when a response is received.
+  /**
+   * The callback only notifies about the response, which stays queued until
+   * it is taken, e.g. from the executor the callback hands it over to.
+   * It is called right away for the responses already waiting.
+   * Once this returns, the previous callback is not running and not called anymore,
+   * except in the thread calling this, when the callback replaces itself.
+   *
+   * No lock is held while the callback runs, it may call this or take responses.
+   *
+   * \param[in] callback Function to call, or `nullptr` to stop being notified.
+   * \param[in] user_data Argument passed to the callback along with the number of responses.
+   */
+  void
+  setResponseCallback(ResponseCallback callback, const void * user_data)
+  {
+    size_t waiting;
+    uint64_t generation;
+    {
+      // Responses are only queued under internalMutex_ and taken under parkedMutex_
+      std::lock_guard<std::mutex> lock(internalMutex_);
+      std::lock_guard<std::mutex> callback_lock(callbackMutex_);
+      std::lock_guard<std::mutex> parked_lock(parkedMutex_);
+      responseCallback_ = callback;
+      callbackUserData_ = user_data;
+      generation = ++callbackGeneration_;
+      waiting = responses_.size() + parked_.size();
+    }
+
+    std::unique_lock<std::mutex> callback_lock(callbackMutex_);
+    std::thread::id self = std::this_thread::get_id();
+    callbackIdle_.wait(
+      callback_lock, [this, generation, self]() {
+        return std::none_of(
+          runningCallbacks_.begin(), runningCallbacks_.end(),
+          [generation, self](const RunningCallback & running) {
+            return running.generation < generation && running.thread != self;
+          });
+      });
+    if (callback != nullptr && waiting != 0) {
+      runCallback(callback_lock, callback, user_data, generation, waiting);
     }
   }
 
+  /// Take the oldest response.
+  /**
+   * The buffer of the response must be given back with releaseBuffer().
+   *
+   * \return `false` if there is none
+   */
   bool
   getResponse(CustomClientResponse & response)
   {
-    std::lock_guard<std::mutex> lock(internalMutex_);
+    // Parked responses arrived before the ones still queued. The queue is only popped under
+    // the lock too, otherwise getResponseFor() could be parking older responses meanwhile.
+    std::lock_guard<std::mutex> lock(parkedMutex_);
+    return popParked(response) || responses_.pop(response);
+  }
 
-    if (conditionMutex_ != nullptr) {
-      std::unique_lock<std::mutex> clock(*conditionMutex_);
-      return popResponse(response);
+  /// Take the response to the request with `sequence_number`.
+  /**
+   * The responses queued ahead of it are kept, indexed by the sequence number
+   * of their request, so looking them up later is constant time too.
+   * The buffer of the response must be given back with releaseBuffer().
+   *
+   * \return `false` if that response was not received
+   */
+  bool
+  getResponseFor(int64_t sequence_number, CustomClientResponse & response)
+  {
+    std::lock_guard<std::mutex> lock(parkedMutex_);
+    if (!parked_.take(sequence_number, response)) {
+      parkQueued();
+      if (!parked_.take(sequence_number, response)) {
+        parked_count_.store(parked_.size());
+        return false;
+      }
     }
-    return popResponse(response);
+    parked_count_.store(parked_.size());
+    return true;
+  }
+
+  void
+  releaseBuffer(eprosima::fastcdr::FastBuffer * buffer)
+  {
+    buffer_pool_.release(buffer);
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    ReadyQueue * readyQueue,
+    uint32_t readyToken)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != nullptr && readyQueue_ != readyQueue) {
+      // Another wait set takes this listener over, the previous one has to reattach
+      readyQueue_->invalidate();
+    }
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyQueue_ = readyQueue;
+    readyToken_ = readyToken;
+    if (readyQueue_ != nullptr && hasData()) {
+      readyQueue_->push(readyToken_);
+    }
   }
 
   void
-  detachCondition()
+  detachCondition(const ReadyQueue * readyQueue)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != readyQueue) {
+      return;
+    }
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyQueue_ = nullptr;
   }
 
   bool
   hasData()
   {
-    return list_has_data_.load();
+    return !responses_.empty() || parked_count_.load() != 0;
+  }
+
+  /// Number of received responses which reused a pooled buffer.
+  uint64_t
+  bufferPoolHits() const
+  {
+    return buffer_pool_.hits();
+  }
+
+  /// Number of received responses for which a buffer had to be allocated.
+  uint64_t
+  bufferPoolMisses() const
+  {
+    return buffer_pool_.misses();
+  }
+
+  /// Number of received responses of a KEEP_LAST client dropped because too many were waiting.
+  uint64_t
+  droppedResponses() const
+  {
+    return dropped_responses_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of responses to other clients discarded without being copied.
+  uint64_t
+  discardedResponses() const
+  {
+    return discarded_responses_.load(std::memory_order_relaxed);
   }
 
   void onSubscriptionMatched(
@@ -156,26 +376,120 @@ public:
       return;
     }
     info_->response_subscriber_matched_count_.store(publishers_.size());
+    update_server_available(info_);
   }
 
 private:
-  bool popResponse(CustomClientResponse & response) RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  // Queue a taken response, making room for it as configured by the history QoS.
+  bool
+  queueResponse(CustomClientResponse & response)
   {
-    if (!list.empty()) {
-      response = std::move(list.front());
-      list.pop_front();
-      list_has_data_.store(!list.empty());
-      return true;
+    for (;;) {
+      if (responses_.size() + parked_count_.load() < depth_ && responses_.push(response)) {
+        return true;
+      }
+      if (!keep_last_) {
+        // Parked after the queued responses, which keeps them all in arrival order
+        std::lock_guard<std::mutex> lock(parkedMutex_);
+        parkQueued();
+        park(response);
+        parked_count_.store(parked_.size());
+        return true;
+      }
+      CustomClientResponse oldest;
+      if (getResponse(oldest)) {
+        dropped_responses_.fetch_add(1, std::memory_order_relaxed);
+        buffer_pool_.release(oldest.buffer_);
+      }
     }
-    return false;
-  };
+  }
+
+  static int64_t
+  sequenceNumber(const CustomClientResponse & response)
+  {
+    return ((int64_t)response.sample_identity_.sequence_number().high) << 32 |
+           response.sample_identity_.sequence_number().low;
+  }
+
+  // Call a copy of the callback without holding callbackMutex_, which is held on entry and exit.
+  void
+  runCallback(
+    std::unique_lock<std::mutex> & callback_lock, ResponseCallback callback,
+    const void * user_data, uint64_t generation, size_t number_of_responses)
+  {
+    RunningCallback running{std::this_thread::get_id(), generation};
+    runningCallbacks_.push_back(running);
+    callback_lock.unlock();
+    callback(user_data, number_of_responses);
+    callback_lock.lock();
+    runningCallbacks_.erase(
+      std::find_if(
+        runningCallbacks_.begin(), runningCallbacks_.end(),
+        [&running](const RunningCallback & other) {
+          return other.thread == running.thread && other.generation == running.generation;
+        }));
+    callbackIdle_.notify_all();
+  }
+
+  // Park the queued responses, after the ones already parked.
+  void
+  parkQueued() RCPPUTILS_TSA_REQUIRES(parkedMutex_)
+  {
+    CustomClientResponse queued;
+    while (responses_.pop(queued)) {
+      park(queued);
+    }
+  }
+
+  void
+  park(const CustomClientResponse & response) RCPPUTILS_TSA_REQUIRES(parkedMutex_)
+  {
+    if (!parked_.park(sequenceNumber(response), response)) {
+      // A duplicate of a response which was not taken yet
+      buffer_pool_.release(response.buffer_);
+    }
+  }
+
+  // Take the oldest parked response, they are all older than the queued ones.
+  bool
+  popParked(CustomClientResponse & response) RCPPUTILS_TSA_REQUIRES(parkedMutex_)
+  {
+    if (!parked_.takeOldest(response)) {
+      return false;
+    }
+    parked_count_.store(parked_.size());
+    return true;
+  }
 
   CustomClientInfo * info_;
   std::mutex internalMutex_;
-  std::list<CustomClientResponse> list RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-  std::atomic_bool list_has_data_;
+  const bool keep_last_;
+  const size_t depth_;
+  rmw_fastrtps_shared_cpp::BoundedQueue<CustomClientResponse> responses_;
+  rmw_fastrtps_shared_cpp::FastBufferPool buffer_pool_;
+  std::atomic<uint64_t> discarded_responses_;
+  std::atomic<uint64_t> dropped_responses_;
+  // Responses moved out of responses_ by getResponseFor(), by request sequence number
+  std::mutex parkedMutex_;
+  rmw_fastrtps_shared_cpp::ParkedQueue<CustomClientResponse> parked_
+  RCPPUTILS_TSA_GUARDED_BY(parkedMutex_);
+  std::atomic_size_t parked_count_;
+  std::mutex callbackMutex_;
+  ResponseCallback responseCallback_ RCPPUTILS_TSA_GUARDED_BY(callbackMutex_);
+  const void * callbackUserData_ RCPPUTILS_TSA_GUARDED_BY(callbackMutex_);
+  // Incremented by every setResponseCallback(), to wait only for the callbacks it replaced
+  uint64_t callbackGeneration_ RCPPUTILS_TSA_GUARDED_BY(callbackMutex_);
+  struct RunningCallback
+  {
+    std::thread::id thread;
+    uint64_t generation;
+  };
+  std::vector<RunningCallback> runningCallbacks_ RCPPUTILS_TSA_GUARDED_BY(callbackMutex_);
+  std::condition_variable callbackIdle_;
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  ReadyQueue * readyQueue_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  uint32_t readyToken_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::set<eprosima::fastrtps::rtps::GUID_t> publishers_;
 };
 
@@ -203,6 +517,7 @@ public:
       return;
     }
     info_->request_publisher_matched_count_.store(subscriptions_.size());
+    update_server_available(info_);
   }
 
 private:
@@ -34,6 +34,7 @@
 #include "rmw/event.h"
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/ready_queue.hpp"
 
 
 class EventListenerInterface
@@ -43,12 +44,25 @@ protected:
 
 public:
   /// Connect a condition variable so a waiter can be notified of new data.
+  /**
+    * \param conditionMutex The mutex protecting the wait set's decision to wait.
+    * \param conditionVariable The condition variable the wait set waits on.
+    * \param readyQueue The wait set's ready queue, `readyToken` is pushed to it
+    *   whenever the listener becomes ready, including right away if it already is.
+    * \param readyToken The token identifying this listener in `readyQueue`.
+    */
   virtual void attachCondition(
     std::mutex * conditionMutex,
-    std::condition_variable * conditionVariable) = 0;
+    std::condition_variable * conditionVariable,
+    ReadyQueue * readyQueue,
+    uint32_t readyToken) = 0;
 
   /// Unset the information from attachCondition.
-  virtual void detachCondition() = 0;
+  /**
+    * \param readyQueue The ready queue given to attachCondition, nothing is done
+    *   if the listener was attached to another wait set since.
+    */
+  virtual void detachCondition(const ReadyQueue * readyQueue) = 0;
 
   /// Check if there is new data available for a specific event type.
   /**
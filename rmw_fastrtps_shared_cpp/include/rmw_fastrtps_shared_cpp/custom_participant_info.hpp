@@ -15,9 +15,18 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_PARTICIPANT_INFO_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_PARTICIPANT_INFO_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "fastrtps/attributes/ParticipantAttributes.h"
@@ -30,6 +39,7 @@
 #include "rmw/impl/cpp/key_value.hpp"
 #include "rmw/rmw.h"
 
+#include "graph_change_journal.hpp"
 #include "rmw_common.hpp"
 
 #include "topic_cache.hpp"
@@ -53,10 +63,122 @@ typedef struct CustomParticipantInfo
 class ParticipantListener : public eprosima::fastrtps::ParticipantListener
 {
 public:
-  explicit ParticipantListener(rmw_guard_condition_t * graph_guard_condition)
-  : graph_guard_condition_(graph_guard_condition)
+  /// Names and their types, in the order reported by the graph queries.
+  using NamesAndTypes = std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+  /// Graph queries whose result is kept until the topic caches change.
+  enum class GraphQuery
+  {
+    TOPICS,
+    TOPICS_NO_DEMANGLE,
+    SERVICES,
+    NODE_PUBLISHERS,
+    NODE_PUBLISHERS_NO_DEMANGLE,
+    NODE_SUBSCRIBERS,
+    NODE_SUBSCRIBERS_NO_DEMANGLE,
+    NODE_SERVICES,
+    NODE_CLIENTS,
+  };
+
+  /// Nodes discovered by the participant, never modified once published.
+  struct DiscoveredNodes
+  {
+    struct Node
+    {
+      std::string name;
+      std::string namespace_;
+    };
+
+    struct NameHash
+    {
+      size_t operator()(const std::pair<std::string, std::string> & name) const
+      {
+        std::hash<std::string> hash;
+        return hash(name.first) ^ (hash(name.second) << 1);
+      }
+    };
+
+    /// Node with the lowest GUID for a (namespace, name), and the number of nodes sharing it.
+    struct NameEntry
+    {
+      eprosima::fastrtps::rtps::GUID_t guid;
+      size_t count;
+    };
+
+    std::map<eprosima::fastrtps::rtps::GUID_t, Node> nodes;
+    std::unordered_map<std::pair<std::string, std::string>, NameEntry, NameHash> guids_by_name;
+
+    /// Add a node not known yet, updating only the index entry of its name.
+    void add(const eprosima::fastrtps::rtps::GUID_t & guid, Node node)
+    {
+      auto indexed = guids_by_name.emplace(
+        std::make_pair(node.namespace_, node.name), NameEntry{guid, 0});
+      NameEntry & entry = indexed.first->second;
+      if (guid < entry.guid) {
+        entry.guid = guid;
+      }
+      ++entry.count;
+      nodes.emplace(guid, std::move(node));
+    }
+
+    /// Remove a known node, updating only the index entry of its name.
+    void remove(const eprosima::fastrtps::rtps::GUID_t & guid)
+    {
+      auto found = nodes.find(guid);
+      if (found == nodes.end()) {
+        return;
+      }
+      auto indexed = guids_by_name.find(
+        std::make_pair(found->second.namespace_, found->second.name));
+      nodes.erase(found);
+      NameEntry & entry = indexed->second;
+      if (--entry.count == 0) {
+        guids_by_name.erase(indexed);
+      } else if (entry.guid == guid) {
+        // Another node has the same name, look for the lowest GUID among them
+        for (const auto & node : nodes) {
+          if (node.second.namespace_ == indexed->first.first &&
+            node.second.name == indexed->first.second)
+          {
+            entry.guid = node.first;
+            break;
+          }
+        }
+      }
+    }
+  };
+
+  /// Constructor.
+  /**
+   * \param graph_guard_condition guard condition triggered when the graph changes.
+   * \param graph_coalescing_window minimum delay between two triggers of the graph guard
+   *   condition, the changes made meanwhile are notified together. Zero triggers it right away.
+   */
+  explicit ParticipantListener(
+    rmw_guard_condition_t * graph_guard_condition,
+    std::chrono::milliseconds graph_coalescing_window = std::chrono::milliseconds(0))
+  : discovered_nodes_(std::make_shared<DiscoveredNodes>()),
+    graph_guard_condition_(graph_guard_condition),
+    graph_generation_(0),
+    snapshots_generation_(0),
+    graph_changes_(kGraphChangeJournalCapacity),
+    graph_coalescing_window_(graph_coalescing_window),
+    graph_changed_(false),
+    stop_notifier_(false)
   {}
 
+  ~ParticipantListener()
+  {
+    {
+      std::lock_guard<std::mutex> guard(notifier_mutex_);
+      stop_notifier_ = true;
+    }
+    notifier_cv_.notify_one();
+    if (notifier_.joinable()) {
+      notifier_.join();
+    }
+  }
+
   void onParticipantDiscovery(
     eprosima::fastrtps::Participant *,
     eprosima::fastrtps::rtps::ParticipantDiscoveryInfo && info) override
@@ -70,9 +192,11 @@ public:
     }
 
     std::lock_guard<std::mutex> guard(names_mutex_);
+    auto discovered_nodes = get_discovered_nodes();
+    std::shared_ptr<DiscoveredNodes> updated_nodes;
     if (eprosima::fastrtps::rtps::ParticipantDiscoveryInfo::DISCOVERED_PARTICIPANT == info.status) {
       // ignore already known GUIDs
-      if (discovered_names.find(info.info.m_guid) == discovered_names.end()) {
+      if (discovered_nodes->nodes.find(info.info.m_guid) == discovered_nodes->nodes.end()) {
         auto map = rmw::impl::cpp::parse_key_value(info.info.m_userData);
         auto name_found = map.find("name");
         auto ns_found = map.find("namespace");
@@ -93,48 +217,111 @@ public:
         }
         // ignore discovered participants without a name
         if (!name.empty()) {
-          discovered_names[info.info.m_guid] = name;
-          discovered_namespaces[info.info.m_guid] = namespace_;
+          updated_nodes = std::make_shared<DiscoveredNodes>(*discovered_nodes);
+          updated_nodes->add(info.info.m_guid, DiscoveredNodes::Node{name, namespace_});
         }
       }
     } else {
-      {
-        auto it = discovered_names.find(info.info.m_guid);
-        // only consider known GUIDs
-        if (it != discovered_names.end()) {
-          discovered_names.erase(it);
-        }
-      }
-      {
-        auto it = discovered_namespaces.find(info.info.m_guid);
-        // only consider known GUIDs
-        if (it != discovered_namespaces.end()) {
-          discovered_namespaces.erase(it);
-        }
+      // only consider known GUIDs
+      if (discovered_nodes->nodes.find(info.info.m_guid) != discovered_nodes->nodes.end()) {
+        updated_nodes = std::make_shared<DiscoveredNodes>(*discovered_nodes);
+        updated_nodes->remove(info.info.m_guid);
       }
     }
+    if (updated_nodes) {
+      std::atomic_store(
+        &discovered_nodes_, std::shared_ptr<const DiscoveredNodes>(std::move(updated_nodes)));
+    }
   }
 
-  std::vector<std::string> get_discovered_names() const
+  /// Get the nodes discovered so far, without waiting for an update of them to complete.
+  /**
+   * The shared_ptr atomics may still take a lock internal to the standard library,
+   * only held for the copy of the pointer.
+   */
+  std::shared_ptr<const DiscoveredNodes> get_discovered_nodes() const
   {
-    std::lock_guard<std::mutex> guard(names_mutex_);
-    std::vector<std::string> names(discovered_names.size());
-    size_t i = 0;
-    for (auto it : discovered_names) {
-      names[i++] = it.second;
-    }
-    return names;
+    return std::atomic_load(&discovered_nodes_);
   }
 
-  std::vector<std::string> get_discovered_namespaces() const
+  /// Number of changes recorded in the topic caches so far.
+  uint64_t graph_generation() const
   {
-    std::lock_guard<std::mutex> guard(names_mutex_);
-    std::vector<std::string> namespaces(discovered_namespaces.size());
-    size_t i = 0;
-    for (auto it : discovered_namespaces) {
-      namespaces[i++] = it.second;
+    return graph_generation_.load();
+  }
+
+  /// Get the result of a graph query, only built if the topic caches changed since the last time.
+  /**
+   * The result is shared with the other callers until the next change, it must not be modified.
+   *
+   * \param query the query.
+   * \param guid node the query is about, unknown for the queries about the whole graph.
+   * \param build function filling the result of the query from the topic caches.
+   * \return the result of the query.
+   */
+  template<typename BuildFunction>
+  std::shared_ptr<const NamesAndTypes>
+  get_graph_snapshot(
+    GraphQuery query, const eprosima::fastrtps::rtps::GUID_t & guid, BuildFunction build)
+  {
+    const SnapshotKey key(query, guid);
+    // The snapshot is built from the caches as they are at this generation or later
+    uint64_t generation = graph_generation_.load();
+    {
+      std::lock_guard<std::mutex> guard(snapshots_mutex_);
+      if (snapshots_generation_ != generation) {
+        snapshots_.clear();
+        snapshots_generation_ = generation;
+      }
+      auto it = snapshots_.find(key);
+      if (it != snapshots_.end()) {
+        return it->second;
+      }
+    }
+    auto snapshot = std::make_shared<NamesAndTypes>();
+    build(*snapshot);
+    {
+      std::lock_guard<std::mutex> guard(snapshots_mutex_);
+      if (snapshots_generation_ == generation) {
+        snapshots_[key] = snapshot;
+      }
     }
-    return namespaces;
+    return snapshot;
+  }
+
+  /// Get the endpoint changes recorded after `sequence`, oldest first.
+  /**
+   * Only the last kGraphChangeJournalCapacity changes are kept.
+   *
+   * \param sequence sequence of the last change known by the caller.
+   * \param changes vector the changes are appended to.
+   * \return `false` if the changes following `sequence` are not all known anymore, the caller
+   *   has to start over from get_graph_endpoints() then.
+   */
+  bool get_graph_changes_since(
+    uint64_t sequence, std::vector<rmw_fastrtps_shared_cpp::GraphChange> & changes) const
+  {
+    return graph_changes_.getChangesSince(sequence, changes);
+  }
+
+  /// Get the endpoints known so far, as the changes which added them.
+  /**
+   * An endpoint appears as many times as it was discovered, e.g. a node with
+   * two publishers on the same topic.
+   *
+   * \param endpoints vector the endpoints are appended to.
+   * \return sequence of the last change taken into account, to pass to get_graph_changes_since().
+   */
+  uint64_t get_graph_endpoints(std::vector<rmw_fastrtps_shared_cpp::GraphChange> & endpoints)
+  {
+    // Changes are recorded while holding the mutex of their cache, so with both
+    // held the caches match the journal exactly.
+    std::lock_guard<std::mutex> reader_guard(reader_topic_cache.getMutex());
+    std::lock_guard<std::mutex> writer_guard(writer_topic_cache.getMutex());
+    uint64_t sequence = graph_changes_.lastSequence();
+    append_endpoints(reader_topic_cache(), true, sequence, endpoints);
+    append_endpoints(writer_topic_cache(), false, sequence, endpoints);
+    return sequence;
   }
 
   void onSubscriberDiscovery(
@@ -168,28 +355,121 @@ public:
     bool trigger;
     {
       std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+      // Interned by the cache, the journal only takes a reference on them
+      TopicCache::SharedName topic_name;
+      TopicCache::SharedName type_name;
       if (is_alive) {
         trigger = topic_cache().addTopic(proxyData.RTPSParticipantKey(),
-            proxyData.topicName().to_string(), proxyData.typeName().to_string());
+            proxyData.topicName().c_str(), proxyData.typeName().c_str(), &topic_name, &type_name);
       } else {
         trigger = topic_cache().removeTopic(proxyData.RTPSParticipantKey(),
-            proxyData.topicName().to_string(), proxyData.typeName().to_string());
+            proxyData.topicName().c_str(), proxyData.typeName().c_str(), &topic_name, &type_name);
+      }
+      if (trigger) {
+        graph_changes_.record(is_alive, is_reader, iHandle2GUID(proxyData.RTPSParticipantKey()),
+          std::move(topic_name), std::move(type_name));
       }
     }
     if (trigger) {
-      rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
-        graph_guard_condition_->implementation_identifier,
-        graph_guard_condition_);
+      ++graph_generation_;
+      notify_graph_change();
     }
   }
 
-  using guid_map_t = std::map<eprosima::fastrtps::rtps::GUID_t, std::string>;
-  mutable std::mutex names_mutex_;
-  guid_map_t discovered_names RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
-  guid_map_t discovered_namespaces RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
+  // Serializes the updates of discovered_nodes_, readers only go through the shared_ptr atomics
+  std::mutex names_mutex_;
+  std::shared_ptr<const DiscoveredNodes> discovered_nodes_;
   LockedObject<TopicCache> reader_topic_cache;
   LockedObject<TopicCache> writer_topic_cache;
   rmw_guard_condition_t * graph_guard_condition_;
+
+  /// Number of endpoint changes kept for get_graph_changes_since().
+  static constexpr size_t kGraphChangeJournalCapacity = 1024;
+
+private:
+  using SnapshotKey = std::pair<GraphQuery, eprosima::fastrtps::rtps::GUID_t>;
+
+  static void append_endpoints(
+    const TopicCache & topic_cache, bool is_reader, uint64_t sequence,
+    std::vector<rmw_fastrtps_shared_cpp::GraphChange> & endpoints)
+  {
+    topic_cache.forEachParticipant(
+      [&](const eprosima::fastrtps::rtps::GUID_t & guid) {
+        topic_cache.forEachSharedTopicTypeOf(guid,
+          [&](const TopicCache::SharedName & topic, const TopicCache::SharedName & type,
+          size_t count) {
+            endpoints.insert(endpoints.end(), count,
+              rmw_fastrtps_shared_cpp::GraphChange{sequence, true, is_reader, guid, topic, type});
+          });
+      });
+  }
+
+  void trigger_graph_guard_condition()
+  {
+    rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
+      graph_guard_condition_->implementation_identifier,
+      graph_guard_condition_);
+  }
+
+  // Trigger the graph guard condition, at most once per coalescing window if there is one.
+  void notify_graph_change()
+  {
+    if (graph_coalescing_window_.count() <= 0) {
+      trigger_graph_guard_condition();
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> guard(notifier_mutex_);
+      graph_changed_ = true;
+      if (!notifier_.joinable()) {
+        // Started by the first change, so that nodes seeing none do not pay for a thread
+        try {
+          notifier_ = std::thread(&ParticipantListener::run_notifier, this);
+        } catch (const std::system_error &) {
+          graph_changed_ = false;
+          trigger_graph_guard_condition();
+          return;
+        }
+      }
+    }
+    notifier_cv_.notify_one();
+  }
+
+  void run_notifier()
+  {
+    std::unique_lock<std::mutex> lock(notifier_mutex_);
+    while (!stop_notifier_) {
+      if (!graph_changed_) {
+        notifier_cv_.wait(lock);
+        continue;
+      }
+      // The first change of a burst is notified right away, the next ones at the end of the window
+      graph_changed_ = false;
+      lock.unlock();
+      trigger_graph_guard_condition();
+      lock.lock();
+      auto deadline = std::chrono::steady_clock::now() + graph_coalescing_window_;
+      while (!stop_notifier_ &&
+        notifier_cv_.wait_until(lock, deadline) != std::cv_status::timeout)
+      {
+      }
+    }
+  }
+
+  std::atomic<uint64_t> graph_generation_;
+  std::mutex snapshots_mutex_;
+  uint64_t snapshots_generation_ RCPPUTILS_TSA_GUARDED_BY(snapshots_mutex_);
+  std::map<SnapshotKey, std::shared_ptr<const NamesAndTypes>> snapshots_
+  RCPPUTILS_TSA_GUARDED_BY(snapshots_mutex_);
+  rmw_fastrtps_shared_cpp::GraphChangeJournal graph_changes_;
+
+  const std::chrono::milliseconds graph_coalescing_window_;
+  std::mutex notifier_mutex_;
+  std::condition_variable notifier_cv_;
+  bool graph_changed_ RCPPUTILS_TSA_GUARDED_BY(notifier_mutex_);
+  bool stop_notifier_ RCPPUTILS_TSA_GUARDED_BY(notifier_mutex_);
+  // Only started with a coalescing window, once the graph changed
+  std::thread notifier_;
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_PARTICIPANT_INFO_HPP_
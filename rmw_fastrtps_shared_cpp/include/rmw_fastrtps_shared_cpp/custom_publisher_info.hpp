@@ -18,6 +18,7 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
 #include <set>
 
 #include "fastrtps/publisher/Publisher.h"
@@ -28,6 +29,8 @@
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_event_info.hpp"
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/serialization_scratch.hpp"
 
 
 class PubListener;
@@ -41,6 +44,12 @@ typedef struct CustomPublisherInfo : public CustomEventInfo
   rmw_fastrtps_shared_cpp::TypeSupport * type_support_;
   rmw_gid_t publisher_gid;
   const char * typesupport_identifier_;
+  /// Storage lent by rmw_borrow_loaned_message(), only set for plain message types.
+  std::unique_ptr<rmw_fastrtps_shared_cpp::LoanedMessagePool> loan_pool_;
+  /// Type support the messages of loan_pool_ are made with.
+  const rosidl_message_type_support_t * loan_type_support_;
+  /// Temporaries reused by the typesupport each time a message is published.
+  rmw_fastrtps_shared_cpp::SerializationScratch serialization_scratch_;
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   EventListenerInterface *
@@ -54,7 +63,9 @@ public:
   : deadline_changes_(false),
     liveliness_changes_(false),
     conditionMutex_(nullptr),
-    conditionVariable_(nullptr)
+    conditionVariable_(nullptr),
+    readyQueue_(nullptr),
+    readyToken_(0)
   {
     (void) info;
   }
@@ -104,19 +115,39 @@ public:
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    ReadyQueue * readyQueue,
+    uint32_t readyToken) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != nullptr && readyQueue_ != readyQueue) {
+      // Another wait set takes this listener over, the previous one has to reattach
+      readyQueue_->invalidate();
+    }
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyQueue_ = readyQueue;
+    readyToken_ = readyToken;
+    if (readyQueue_ != nullptr &&
+      (deadline_changes_.load(std::memory_order_relaxed) ||
+      liveliness_changes_.load(std::memory_order_relaxed)))
+    {
+      readyQueue_->push(readyToken_);
+    }
   }
 
   void
-  detachCondition()
+  detachCondition(const ReadyQueue * readyQueue) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != readyQueue) {
+      return;
+    }
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyQueue_ = nullptr;
   }
 
 private:
@@ -135,6 +166,8 @@ private:
 
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  ReadyQueue * readyQueue_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  uint32_t readyToken_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_PUBLISHER_INFO_HPP_
@@ -15,9 +15,10 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_SERVICE_INFO_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_SERVICE_INFO_HPP_
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
-#include <list>
+#include <deque>
 #include <mutex>
 
 #include "fastcdr/FastBuffer.h"
@@ -25,6 +26,7 @@
 #include "fastrtps/participant/Participant.h"
 #include "fastrtps/publisher/Publisher.h"
 #include "fastrtps/publisher/PublisherListener.h"
+#include "fastrtps/qos/QosPolicies.h"
 #include "fastrtps/subscriber/Subscriber.h"
 #include "fastrtps/subscriber/SubscriberListener.h"
 #include "fastrtps/subscriber/SampleInfo.h"
@@ -32,6 +34,9 @@
 #include "rcpputils/thread_safety_annotations.hpp"
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/bounded_queue.hpp"
+#include "rmw_fastrtps_shared_cpp/fast_buffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/ready_queue.hpp"
 
 class ServiceListener;
 
@@ -50,21 +55,45 @@ typedef struct CustomServiceRequest
 {
   eprosima::fastrtps::rtps::SampleIdentity sample_identity_;
   eprosima::fastcdr::FastBuffer * buffer_;
+  // Length of the request in buffer_, the rest of it is left over from earlier requests
+  size_t length_;
 
   CustomServiceRequest()
-  : buffer_(nullptr) {}
+  : buffer_(nullptr), length_(0) {}
 } CustomServiceRequest;
 
 class ServiceListener : public eprosima::fastrtps::SubscriberListener
 {
 public:
-  explicit ServiceListener(CustomServiceInfo * info)
-  : info_(info), list_has_data_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr)
+  // Requests received but not taken yet by a KEEP_ALL service, beyond which they overflow
+  static constexpr size_t kRequestQueueCapacity = 1024;
+  // Idle request buffers kept for reuse
+  static constexpr size_t kBufferPoolCapacity = 64;
+
+  /// Listener queueing at most as many requests as the `history` of the request reader.
+  /**
+   * With KEEP_LAST, the oldest request is dropped to make room for a new one
+   * once `depth` requests are waiting.
+   * With KEEP_ALL, no request is dropped: beyond kRequestQueueCapacity the
+   * new ones overflow into unbounded storage, taken after the queued ones.
+   */
+  ServiceListener(CustomServiceInfo * info, const eprosima::fastrtps::HistoryQosPolicy & history)
+  : info_(info), keep_last_(eprosima::fastrtps::KEEP_LAST_HISTORY_QOS == history.kind),
+    depth_(keep_last_ ? std::max<size_t>(history.depth, 1) : kRequestQueueCapacity),
+    requests_(depth_), buffer_pool_(kBufferPoolCapacity), dropped_requests_(0),
+    overflow_count_(0), conditionMutex_(nullptr), conditionVariable_(nullptr),
+    readyQueue_(nullptr), readyToken_(0)
   {
     (void)info_;
   }
 
+  ~ServiceListener()
+  {
+    CustomServiceRequest request;
+    while (requests_.pop(request)) {
+      buffer_pool_.release(request.buffer_);
+    }
+  }
 
   void
   onNewDataMessage(eprosima::fastrtps::Subscriber * sub)
@@ -72,88 +101,174 @@ public:
     assert(sub);
 
     CustomServiceRequest request;
-    request.buffer_ = new eprosima::fastcdr::FastBuffer();
+    request.buffer_ = buffer_pool_.acquire();
+    if (request.buffer_ == nullptr) {
+      return;
+    }
     eprosima::fastrtps::SampleInfo_t sinfo;
 
     rmw_fastrtps_shared_cpp::SerializedData data;
     data.is_cdr_buffer = true;
     data.data = request.buffer_;
-    if (sub->takeNextData(&data, &sinfo)) {
-      if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
-        request.sample_identity_ = sinfo.sample_identity;
-
-        std::lock_guard<std::mutex> lock(internalMutex_);
-
-        if (conditionMutex_ != nullptr) {
-          std::unique_lock<std::mutex> clock(*conditionMutex_);
-          list.push_back(request);
-          // the change to list_has_data_ needs to be mutually exclusive with
-          // rmw_wait() which checks hasData() and decides if wait() needs to
-          // be called
-          list_has_data_.store(true);
-          clock.unlock();
-          conditionVariable_->notify_one();
-        } else {
-          list.push_back(request);
-          list_has_data_.store(true);
-        }
-      }
+    if (!sub->takeNextData(&data, &sinfo) ||
+      eprosima::fastrtps::rtps::ALIVE != sinfo.sampleKind)
+    {
+      buffer_pool_.release(request.buffer_);
+      return;
     }
-  }
+    request.sample_identity_ = sinfo.sample_identity;
+    request.length_ = data.length;
 
-  CustomServiceRequest
-  getRequest()
-  {
     std::lock_guard<std::mutex> lock(internalMutex_);
-    CustomServiceRequest request;
 
     if (conditionMutex_ != nullptr) {
       std::unique_lock<std::mutex> clock(*conditionMutex_);
-      if (!list.empty()) {
-        request = list.front();
-        list.pop_front();
-        list_has_data_.store(!list.empty());
+      // the push needs to be mutually exclusive with rmw_wait() which checks
+      // hasData() and decides if wait() needs to be called
+      if (!queueRequest(request)) {
+        return;
       }
-    } else {
-      if (!list.empty()) {
-        request = list.front();
-        list.pop_front();
-        list_has_data_.store(!list.empty());
+      if (readyQueue_ != nullptr) {
+        readyQueue_->push(readyToken_);
       }
+      clock.unlock();
+      conditionVariable_->notify_one();
+    } else {
+      queueRequest(request);
     }
+  }
 
+  /// Take the oldest request, its buffer is null if there is none.
+  /**
+   * Any number of threads may take requests concurrently, this takes neither
+   * the listener mutex nor the one of the attached wait set. Only the requests
+   * which overflowed the queue of a KEEP_ALL service are taken under a lock.
+   * The buffer of the request must be given back with releaseBuffer().
+   */
+  CustomServiceRequest
+  getRequest()
+  {
+    CustomServiceRequest request;
+    if (!requests_.pop(request) && overflow_count_.load() != 0) {
+      std::lock_guard<std::mutex> lock(overflowMutex_);
+      // The queued requests are all older than the overflowed ones, even those queued meanwhile
+      if (!requests_.pop(request) && !overflow_.empty()) {
+        request = overflow_.front();
+        overflow_.pop_front();
+        overflow_count_.store(overflow_.size());
+      }
+    }
     return request;
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  releaseBuffer(eprosima::fastcdr::FastBuffer * buffer)
+  {
+    buffer_pool_.release(buffer);
+  }
+
+  void
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    ReadyQueue * readyQueue,
+    uint32_t readyToken)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != nullptr && readyQueue_ != readyQueue) {
+      // Another wait set takes this listener over, the previous one has to reattach
+      readyQueue_->invalidate();
+    }
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyQueue_ = readyQueue;
+    readyToken_ = readyToken;
+    if (readyQueue_ != nullptr && hasData()) {
+      readyQueue_->push(readyToken_);
+    }
   }
 
   void
-  detachCondition()
+  detachCondition(const ReadyQueue * readyQueue)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != readyQueue) {
+      return;
+    }
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyQueue_ = nullptr;
   }
 
   bool
   hasData()
   {
-    return list_has_data_.load();
+    return !requests_.empty() || overflow_count_.load() != 0;
+  }
+
+  /// Number of received requests which reused a pooled buffer.
+  uint64_t
+  bufferPoolHits() const
+  {
+    return buffer_pool_.hits();
+  }
+
+  /// Number of received requests for which a buffer had to be allocated.
+  uint64_t
+  bufferPoolMisses() const
+  {
+    return buffer_pool_.misses();
+  }
+
+  /// Number of received requests of a KEEP_LAST service dropped because too many were waiting.
+  uint64_t
+  droppedRequests() const
+  {
+    return dropped_requests_.load(std::memory_order_relaxed);
   }
 
 private:
+  // Queue a taken request, making room for it as configured by the history QoS.
+  bool
+  queueRequest(CustomServiceRequest & request)
+  {
+    if (!keep_last_) {
+      // Queued only while nothing overflowed, so that the requests are taken in order
+      std::lock_guard<std::mutex> lock(overflowMutex_);
+      if (overflow_.empty() && requests_.push(request)) {
+        return true;
+      }
+      overflow_.push_back(request);
+      overflow_count_.store(overflow_.size());
+      return true;
+    }
+    for (;;) {
+      if (requests_.size() < depth_ && requests_.push(request)) {
+        return true;
+      }
+      CustomServiceRequest oldest;
+      if (requests_.pop(oldest)) {
+        dropped_requests_.fetch_add(1, std::memory_order_relaxed);
+        buffer_pool_.release(oldest.buffer_);
+      }
+    }
+  }
+
   CustomServiceInfo * info_;
   std::mutex internalMutex_;
-  std::list<CustomServiceRequest> list RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-  std::atomic_bool list_has_data_;
+  const bool keep_last_;
+  const size_t depth_;
+  rmw_fastrtps_shared_cpp::BoundedQueue<CustomServiceRequest> requests_;
+  rmw_fastrtps_shared_cpp::FastBufferPool buffer_pool_;
+  std::atomic<uint64_t> dropped_requests_;
+  // Requests received by a KEEP_ALL service while requests_ was full
+  std::mutex overflowMutex_;
+  std::deque<CustomServiceRequest> overflow_ RCPPUTILS_TSA_GUARDED_BY(overflowMutex_);
+  std::atomic_size_t overflow_count_;
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  ReadyQueue * readyQueue_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  uint32_t readyToken_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_SERVICE_INFO_HPP_
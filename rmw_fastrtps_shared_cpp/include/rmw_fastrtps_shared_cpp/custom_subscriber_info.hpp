@@ -56,7 +56,9 @@ public:
     deadline_changes_(false),
     liveliness_changes_(false),
     conditionMutex_(nullptr),
-    conditionVariable_(nullptr)
+    conditionVariable_(nullptr),
+    readyQueue_(nullptr),
+    readyToken_(0)
   {
     // Field is not used right now
     (void)info;
@@ -93,6 +95,9 @@ public:
     ConditionalScopedLock clock(conditionMutex_, conditionVariable_);
 
     data_.store(unread_count, std::memory_order_relaxed);
+    if (readyQueue_ != nullptr && unread_count > 0) {
+      readyQueue_->push(readyToken_);
+    }
   }
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
@@ -118,19 +123,40 @@ public:
 
   // SubListener API
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    ReadyQueue * readyQueue,
+    uint32_t readyToken) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != nullptr && readyQueue_ != readyQueue) {
+      // Another wait set takes this listener over, the previous one has to reattach
+      readyQueue_->invalidate();
+    }
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyQueue_ = readyQueue;
+    readyToken_ = readyToken;
+    if (readyQueue_ != nullptr &&
+      (hasData() ||
+      deadline_changes_.load(std::memory_order_relaxed) ||
+      liveliness_changes_.load(std::memory_order_relaxed)))
+    {
+      readyQueue_->push(readyToken_);
+    }
   }
 
   void
-  detachCondition()
+  detachCondition(const ReadyQueue * readyQueue) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != readyQueue) {
+      return;
+    }
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyQueue_ = nullptr;
   }
 
   bool
@@ -176,6 +202,8 @@ private:
 
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  ReadyQueue * readyQueue_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  uint32_t readyToken_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
 
   std::set<eprosima::fastrtps::rtps::GUID_t> publishers_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
 };
@@ -0,0 +1,132 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__FAST_BUFFER_POOL_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__FAST_BUFFER_POOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "fastcdr/FastBuffer.h"
+
+#include "./bounded_queue.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Recycled buffers holding the serialized samples taken from a Fast-RTPS reader.
+/**
+ * A buffer given back with release() keeps the storage it grew to, so once the
+ * pool holds enough of them, receiving samples of a similar size does not
+ * allocate anymore.
+ * At most `capacity` idle buffers are kept, the ones released beyond that are deleted.
+ *
+ * The pool follows the typical size of the buffers given back to it.
+ * A buffer which had to grow far beyond it for an unusually large sample is
+ * deleted instead of being kept, so a single large sample does not pin its
+ * memory for the lifetime of the entity.
+ *
+ * Any thread may acquire() and release() concurrently.
+ */
+class FastBufferPool
+{
+public:
+  // Buffers larger than this many times the typical size are not kept
+  static constexpr size_t kOversizeFactor = 4;
+
+  explicit FastBufferPool(size_t capacity)
+  : free_buffers_(capacity), typical_size_(0), hits_(0), misses_(0)
+  {}
+
+  FastBufferPool(const FastBufferPool &) = delete;
+  FastBufferPool & operator=(const FastBufferPool &) = delete;
+
+  ~FastBufferPool()
+  {
+    eprosima::fastcdr::FastBuffer * buffer = nullptr;
+    while (free_buffers_.pop(buffer)) {
+      delete buffer;
+    }
+  }
+
+  /// Get an idle buffer, or a new one if there is none.
+  /**
+   * \return the buffer, or `nullptr` if it could not be allocated
+   */
+  eprosima::fastcdr::FastBuffer *
+  acquire()
+  {
+    eprosima::fastcdr::FastBuffer * buffer = nullptr;
+    if (free_buffers_.pop(buffer)) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return buffer;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return new (std::nothrow) eprosima::fastcdr::FastBuffer();
+  }
+
+  /// Give back a buffer obtained from acquire().
+  void
+  release(eprosima::fastcdr::FastBuffer * buffer)
+  {
+    if (buffer == nullptr) {
+      return;
+    }
+    size_t size = buffer->getBufferSize();
+    // Moving average over roughly the last 8 buffers, races only make it less precise.
+    size_t typical = typical_size_.load(std::memory_order_relaxed);
+    typical_size_.store(
+      typical == 0 ? size : typical - typical / 8 + size / 8, std::memory_order_relaxed);
+    if (typical != 0 && size > kOversizeFactor * typical) {
+      delete buffer;
+      return;
+    }
+    if (!free_buffers_.push(buffer)) {
+      delete buffer;
+    }
+  }
+
+  /// Typical size of the buffers given back to the pool, 0 until one is.
+  size_t
+  typical_size() const
+  {
+    return typical_size_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of acquire() calls served by an idle buffer.
+  uint64_t
+  hits() const
+  {
+    return hits_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of acquire() calls which had to allocate a buffer.
+  uint64_t
+  misses() const
+  {
+    return misses_.load(std::memory_order_relaxed);
+  }
+
+private:
+  BoundedQueue<eprosima::fastcdr::FastBuffer *> free_buffers_;
+  std::atomic_size_t typical_size_;
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__FAST_BUFFER_POOL_HPP_
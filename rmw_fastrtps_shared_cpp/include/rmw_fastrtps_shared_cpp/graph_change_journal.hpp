@@ -0,0 +1,127 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__GRAPH_CHANGE_JOURNAL_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__GRAPH_CHANGE_JOURNAL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fastrtps/rtps/common/Guid.h"
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Endpoint discovered or removed by a participant.
+struct GraphChange
+{
+  /// Position of the change in the journal, the first change is 1.
+  uint64_t sequence;
+  /// Whether the endpoint was discovered, or removed.
+  bool is_alive;
+  /// Whether the endpoint is a reader, or a writer.
+  bool is_reader;
+  /// Participant the endpoint belongs to.
+  eprosima::fastrtps::rtps::GUID_t participant;
+  /// DDS topic name, with its ROS prefix if any.
+  /**
+   * The names are shared with the topic caches and between the changes, so
+   * recording a change does not copy them.
+   */
+  std::shared_ptr<const std::string> topic_name;
+  /// DDS type name.
+  std::shared_ptr<const std::string> type_name;
+};
+
+/// Bounded history of the graph changes, the oldest ones are dropped first.
+/**
+ * A client keeps the sequence of the last change it applied and asks for the
+ * following ones, as long as they were not dropped meanwhile.
+ */
+class GraphChangeJournal
+{
+public:
+  explicit GraphChangeJournal(size_t capacity)
+  : capacity_(capacity), last_sequence_(0)
+  {}
+
+  /// Append a change and return its sequence, the oldest change is dropped when full.
+  uint64_t
+  record(
+    bool is_alive,
+    bool is_reader,
+    const eprosima::fastrtps::rtps::GUID_t & participant,
+    std::shared_ptr<const std::string> topic_name,
+    std::shared_ptr<const std::string> type_name)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (capacity_ == 0) {
+      return ++last_sequence_;
+    }
+    if (changes_.size() == capacity_) {
+      changes_.pop_front();
+    }
+    changes_.push_back(
+      GraphChange{++last_sequence_, is_alive, is_reader, participant, std::move(topic_name),
+        std::move(type_name)});
+    return last_sequence_;
+  }
+
+  /// Sequence of the last recorded change, 0 if none.
+  uint64_t
+  lastSequence() const
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return last_sequence_;
+  }
+
+  /// Append the changes recorded after `sequence` to `changes`, oldest first.
+  /**
+   * \return `false` if some of them were dropped or `sequence` was never
+   *   reached, `changes` is left untouched then.
+   */
+  bool
+  getChangesSince(uint64_t sequence, std::vector<GraphChange> & changes) const
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (sequence > last_sequence_) {
+      return false;
+    }
+    uint64_t first_sequence = last_sequence_ - changes_.size() + 1;
+    if (sequence + 1 < first_sequence) {
+      return false;
+    }
+    auto first = changes_.begin() + static_cast<std::ptrdiff_t>(sequence + 1 - first_sequence);
+    changes.insert(changes.end(), first, changes_.end());
+    return true;
+  }
+
+private:
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  std::deque<GraphChange> changes_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+  uint64_t last_sequence_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__GRAPH_CHANGE_JOURNAL_HPP_
@@ -0,0 +1,102 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__LOANED_MESSAGE_POOL_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__LOANED_MESSAGE_POOL_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "./visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Pool of ROS message storage lent to the user of a publisher or subscription.
+/**
+ * Only meant for plain messages, i.e. fixed size types without strings or
+ * sequences, which can live in a single block of `message_size` bytes.
+ * Slots are recycled instead of freed when given back, so that loaning does
+ * not allocate once the pool reached the number of loans in flight.
+ */
+class LoanedMessagePool
+{
+public:
+  using MessageFunction = std::function<void (void *)>;
+
+  /// Create a pool of `message_size` bytes slots.
+  /**
+   * \param message_size Size of the ROS message type.
+   * \param init Called on a slot before it is lent.
+   * \param fini Called on a slot when it is given back.
+   * \param preallocated Number of slots allocated upfront.
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  LoanedMessagePool(
+    size_t message_size,
+    MessageFunction init,
+    MessageFunction fini,
+    size_t preallocated = 1);
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  ~LoanedMessagePool();
+
+  LoanedMessagePool(const LoanedMessagePool &) = delete;
+  LoanedMessagePool & operator=(const LoanedMessagePool &) = delete;
+
+  /// Lend an initialized message.
+  /**
+   * \return the message, or `nullptr` if no storage could be allocated
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void *
+  borrow();
+
+  /// Give back a message obtained from borrow().
+  /**
+   * \return `false` if `message` is not currently lent by this pool
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  bool
+  give_back(void * message);
+
+  /// Check whether `message` is currently lent by this pool.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  bool
+  is_lent(const void * message);
+
+  size_t
+  message_size() const
+  {
+    return message_size_;
+  }
+
+private:
+  const size_t message_size_;
+  const MessageFunction init_;
+  const MessageFunction fini_;
+
+  std::mutex mutex_;
+  std::vector<void *> free_slots_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+  std::unordered_set<void *> lent_slots_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__LOANED_MESSAGE_POOL_HPP_
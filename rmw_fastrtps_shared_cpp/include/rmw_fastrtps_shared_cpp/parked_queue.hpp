@@ -0,0 +1,124 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__PARKED_QUEUE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__PARKED_QUEUE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Values set aside with a key, taken either by their key or in arrival order.
+/**
+ * Taking a value by key is amortized constant time. The arrival order keeps
+ * the keys of the values already taken by key until they are the majority,
+ * then it is compacted.
+ *
+ * Not thread safe, the caller serializes the calls.
+ */
+template<typename T>
+class ParkedQueue
+{
+public:
+  explicit ParkedQueue(size_t capacity = 0)
+  {
+    values_.reserve(capacity);
+  }
+
+  /// Set `value` aside with `key`, after the values already parked.
+  /**
+   * \return `false` if a value is already parked with `key`, nothing is parked then.
+   */
+  bool
+  park(int64_t key, const T & value)
+  {
+    if (!values_.emplace(key, value).second) {
+      return false;
+    }
+    order_.push_back(key);
+    return true;
+  }
+
+  /// Take the value parked with `key`.
+  /**
+   * \return `false` if there is none
+   */
+  bool
+  take(int64_t key, T & value)
+  {
+    auto it = values_.find(key);
+    if (it == values_.end()) {
+      return false;
+    }
+    value = it->second;
+    values_.erase(it);
+    // Forget the values taken by key once they are the majority
+    if (order_.size() > 2 * values_.size()) {
+      auto last = order_.begin();
+      for (int64_t parked_key : order_) {
+        if (values_.count(parked_key) != 0) {
+          *last++ = parked_key;
+        }
+      }
+      order_.erase(last, order_.end());
+    }
+    return true;
+  }
+
+  /// Take the value parked first among the remaining ones.
+  /**
+   * \return `false` if there is none
+   */
+  bool
+  takeOldest(T & value)
+  {
+    while (!order_.empty()) {
+      // Skip the values already taken by key
+      auto it = values_.find(order_.front());
+      order_.pop_front();
+      if (it != values_.end()) {
+        value = it->second;
+        values_.erase(it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Number of values parked.
+  size_t
+  size() const
+  {
+    return values_.size();
+  }
+
+  /// Number of keys kept for the arrival order, including the ones of values taken by key.
+  size_t
+  orderSize() const
+  {
+    return order_.size();
+  }
+
+private:
+  std::unordered_map<int64_t, T> values_;
+  std::deque<int64_t> order_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__PARKED_QUEUE_HPP_
@@ -0,0 +1,198 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__READY_QUEUE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__READY_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+/// Lock-free queue of "became ready" tokens owned by a wait set.
+/**
+ * Every entity attached to a wait set is given a token in `[0, capacity)`.
+ * Listeners push their token when they transition to having data, and
+ * rmw_wait() pops them, so that it only has to look at the entities which
+ * actually signaled instead of rescanning all of them.
+ *
+ * A token is queued at most once at any time, which bounds the number of
+ * queued elements by the capacity and makes push() never fail for lack of room.
+ *
+ * Any thread may push() or invalidate(); only the thread waiting on the wait
+ * set may pop() or reset().
+ *
+ * On Linux an eventfd can be given with set_event_fd(), which is then written
+ * each time a token gets queued so that the queue can be polled from an event loop.
+ */
+class ReadyQueue
+{
+public:
+  ReadyQueue()
+  : mask_(0), capacity_(0), event_fd_(-1), enqueue_pos_(0), dequeue_pos_(0),
+    invalidated_(false)
+  {
+    reset(0);
+  }
+
+  ReadyQueue(const ReadyQueue &) = delete;
+  ReadyQueue & operator=(const ReadyQueue &) = delete;
+
+  /// Signal `event_fd` on every push() which queues a token, -1 to disable.
+  /**
+   * Must be set before any listener can push to this queue.
+   */
+  void
+  set_event_fd(int event_fd)
+  {
+    event_fd_ = event_fd;
+  }
+
+  /// Drop all queued tokens and make room for `capacity` distinct tokens.
+  /**
+   * Must not be called while any listener can still push to this queue.
+   */
+  void
+  reset(uint32_t capacity)
+  {
+    if (capacity > capacity_ || !cells_) {
+      size_t size = 2;
+      while (size < capacity) {
+        size <<= 1;
+      }
+      cells_.reset(new Cell[size]);
+      queued_.reset(new std::atomic_bool[capacity > 0 ? capacity : 1]);
+      mask_ = size - 1;
+      capacity_ = capacity;
+    }
+    for (size_t i = 0; i <= mask_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    for (uint32_t i = 0; i < capacity_; ++i) {
+      queued_[i].store(false, std::memory_order_relaxed);
+    }
+    enqueue_pos_.store(0, std::memory_order_relaxed);
+    dequeue_pos_.store(0, std::memory_order_release);
+    invalidated_.store(false, std::memory_order_release);
+  }
+
+  /// Queue `token` unless it is already queued.
+  /**
+   * \return `true` if the token was added, `false` if it was already pending.
+   */
+  bool
+  push(uint32_t token)
+  {
+    if (token >= capacity_ || queued_[token].exchange(true, std::memory_order_acq_rel)) {
+      return false;
+    }
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell * cell;
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // Not reachable as long as every token is below capacity_, but never
+        // spin on a full ring from inside a Fast-RTPS callback.
+        queued_[token].store(false, std::memory_order_release);
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->token = token;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+#ifdef __linux__
+    if (event_fd_ >= 0) {
+      // Deduplication above keeps this to one write per token and wakeup.
+      const uint64_t increment = 1;
+      ssize_t written = write(event_fd_, &increment, sizeof(increment));
+      (void)written;
+    }
+#endif
+    return true;
+  }
+
+  /// Take the oldest queued token.
+  /**
+   * \return `false` if no token is queued.
+   */
+  bool
+  pop(uint32_t & token)
+  {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell * cell = &cells_[pos & mask_];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+      return false;
+    }
+    token = cell->token;
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+    // Allow the token to be queued again only once it has been consumed, so
+    // a listener signaling while the waiter processes it is not lost.
+    queued_[token].store(false, std::memory_order_release);
+    return true;
+  }
+
+  bool
+  empty() const
+  {
+    return dequeue_pos_.load(std::memory_order_acquire) ==
+           enqueue_pos_.load(std::memory_order_acquire);
+  }
+
+  /// Record that a listener attached through this queue was attached elsewhere.
+  /**
+   * The owning wait set can no longer rely on its attachments until the next reset().
+   */
+  void
+  invalidate()
+  {
+    invalidated_.store(true, std::memory_order_release);
+  }
+
+  bool
+  invalidated() const
+  {
+    return invalidated_.load(std::memory_order_acquire);
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic_size_t sequence;
+    uint32_t token;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  std::unique_ptr<std::atomic_bool[]> queued_;
+  size_t mask_;
+  uint32_t capacity_;
+  int event_fd_;
+  std::atomic_size_t enqueue_pos_;
+  std::atomic_size_t dequeue_pos_;
+  std::atomic_bool invalidated_;
+};
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__READY_QUEUE_HPP_
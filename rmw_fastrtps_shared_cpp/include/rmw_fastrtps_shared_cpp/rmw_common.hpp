@@ -15,6 +15,10 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__RMW_COMMON_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__RMW_COMMON_HPP_
 
+#include <cstdint>
+#include <vector>
+
+#include "./graph_change_journal.hpp"
 #include "./visibility_control.h"
 
 #include "rmw/error_handling.h"
@@ -33,6 +37,22 @@ __rmw_destroy_client(
   rmw_node_t * node,
   rmw_client_t * client);
 
+/// Set the function called from the middleware thread when the client receives a response.
+/**
+ * The response is not taken, the callback is expected to hand it over to an
+ * executor which takes it, e.g. with __rmw_take_response_for().
+ *
+ * \param[in] callback Function to call, or `nullptr` to stop being notified.
+ * \param[in] user_data Argument passed to the callback along with the number of responses.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_client_set_on_new_response_callback(
+  const char * identifier,
+  rmw_client_t * client,
+  void (* callback)(const void * user_data, size_t number_of_responses),
+  const void * user_data);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_compare_gids_equal(
@@ -108,6 +128,39 @@ RMW_FASTRTPS_SHARED_CPP_PUBLIC
 const rmw_guard_condition_t *
 __rmw_node_get_graph_guard_condition(const rmw_node_t * node);
 
+/// Get the endpoint changes seen by the node after the change `sequence`, oldest first.
+/**
+ * Only the most recent changes are kept. If some of the ones following
+ * `sequence` were dropped, `resync_needed` is set to true and `changes` is
+ * left untouched, __rmw_get_graph_endpoints() then gives the state to start over from.
+ *
+ * \param[in] sequence Sequence of the last change known by the caller, 0 for none.
+ * \param[out] changes Vector the changes are appended to.
+ * \param[out] resync_needed Whether the changes could not be given.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_get_graph_changes(
+  const char * identifier,
+  const rmw_node_t * node,
+  uint64_t sequence,
+  std::vector<GraphChange> * changes,
+  bool * resync_needed);
+
+/// Get the endpoints seen by the node, as the changes which added them.
+/**
+ * \param[out] endpoints Vector the endpoints are appended to.
+ * \param[out] sequence Sequence of the last change taken into account, to pass to
+ *   __rmw_get_graph_changes() afterwards.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_get_graph_endpoints(
+  const char * identifier,
+  const rmw_node_t * node,
+  std::vector<GraphChange> * endpoints,
+  uint64_t * sequence);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_get_node_names(
@@ -132,6 +185,14 @@ __rmw_publish_serialized_message(
   const rmw_serialized_message_t * serialized_message,
   rmw_publisher_allocation_t * allocation);
 
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_publish_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * ros_message,
+  rmw_publisher_allocation_t * allocation);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_publisher_assert_liveliness(
@@ -157,6 +218,21 @@ __rmw_publisher_get_actual_qos(
   const rmw_publisher_t * publisher,
   rmw_qos_profile_t * qos);
 
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_borrow_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const rosidl_message_type_support_t * type_support,
+  void ** ros_message);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_return_loaned_message_from_publisher(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * loaned_message);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_send_request(
@@ -183,6 +259,26 @@ __rmw_take_response(
   void * ros_response,
   bool * taken);
 
+/// Take the response to the request sent with `sequence_id`, if it was received.
+/**
+ * Unlike __rmw_take_response(), which takes the oldest response, the responses
+ * received before the requested one are kept for later takes.
+ *
+ * \param[in] sequence_id Sequence id returned when the request was sent.
+ * \param[out] request_header Header of the taken response.
+ * \param[out] ros_response Response to take into.
+ * \param[out] taken Whether the response was taken.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_response_for(
+  const char * identifier,
+  const rmw_client_t * client,
+  int64_t sequence_id,
+  rmw_request_id_t * request_header,
+  void * ros_response,
+  bool * taken);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_send_response(
@@ -302,6 +398,29 @@ __rmw_take_with_info(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation);
 
+/// Take up to `count` messages from a subscription in one call.
+/**
+ * Messages are deserialized in order into the `count` preallocated messages
+ * pointed to by `ros_messages`.
+ * Compared to calling __rmw_take() in a loop, the state of the subscription
+ * listener is only refreshed once for the whole batch.
+ *
+ * \param[in] count Maximum number of messages to take.
+ * \param[out] ros_messages Array of `count` messages to take into.
+ * \param[out] message_infos Array of `count` message infos, may be null.
+ * \param[out] taken Number of messages taken, the first `taken` entries are valid.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_sequence(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  size_t count,
+  void * const * ros_messages,
+  rmw_message_info_t * message_infos,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_take_serialized_message(
@@ -349,6 +468,23 @@ RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_destroy_wait_set(const char * identifier, rmw_wait_set_t * wait_set);
 
+/// Get the eventfd signaled when entities attached to the wait set may be ready.
+/**
+ * The eventfd is only available on Linux for wait sets created with the
+ * RMW_FASTRTPS_WAIT_SET_EVENTFD environment variable set to 1, `fd` is set to
+ * -1 otherwise.
+ * Once readable, rmw_wait() has to be called with the same entities, e.g.
+ * with a zero timeout, to find out which of them are ready and to consume
+ * the signal.
+ * The wait set keeps ownership of the file descriptor.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_get_wait_set_event_fd(
+  const char * identifier,
+  const rmw_wait_set_t * wait_set,
+  int * fd);
+
 }  // namespace rmw_fastrtps_shared_cpp
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__RMW_COMMON_HPP_
@@ -0,0 +1,81 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__SERIALIZATION_SCRATCH_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__SERIALIZATION_SCRATCH_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Temporaries reused across the serializations done for a single publisher.
+/**
+ * Typesupports which need intermediate objects to serialize some field types
+ * take them from here instead of creating them for every message.
+ * Once their capacity fits the published messages, serializing does not
+ * allocate anymore; every heap allocation made on their behalf is recorded in
+ * allocation_count(), which stops increasing in the steady state.
+ *
+ * The temporaries may only be used while holding mutex().
+ */
+class SerializationScratch
+{
+public:
+  SerializationScratch()
+  : allocations_(0)
+  {}
+
+  SerializationScratch(const SerializationScratch &) = delete;
+  SerializationScratch & operator=(const SerializationScratch &) = delete;
+
+  std::mutex &
+  mutex()
+  {
+    return mutex_;
+  }
+
+  /// Buffer for wide strings, which are converted before being serialized.
+  std::wstring &
+  wstring_buffer()
+  {
+    return wstring_buffer_;
+  }
+
+  /// Record `count` heap allocations made while serializing.
+  void
+  count_allocation(uint64_t count = 1)
+  {
+    allocations_.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /// Number of heap allocations made while serializing so far.
+  uint64_t
+  allocation_count() const
+  {
+    return allocations_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::mutex mutex_;
+  std::wstring wstring_buffer_;
+  std::atomic<uint64_t> allocations_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__SERIALIZATION_SCRATCH_HPP_
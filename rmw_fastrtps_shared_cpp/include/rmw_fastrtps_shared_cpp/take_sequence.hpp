@@ -0,0 +1,58 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__TAKE_SEQUENCE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__TAKE_SEQUENCE_HPP_
+
+#include <cstddef>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Take up to `count` alive samples into `ros_messages`, in order.
+/**
+ * `take_next(ros_message, index, alive)` takes the next sample into `ros_message`,
+ * sets `alive` and returns `false` when there is none left.
+ * A sample which is not alive carries no data, so its message is reused for the
+ * next one.
+ * `data_taken()` is called once at the end if any sample, alive or not, was taken.
+ *
+ * \return the number of alive samples taken, the first ones of `ros_messages`.
+ */
+template<typename TakeNext, typename DataTaken>
+size_t
+take_sequence(
+  size_t count,
+  void * const * ros_messages,
+  TakeNext take_next,
+  DataTaken data_taken)
+{
+  size_t taken = 0;
+  bool took_any = false;
+  bool alive = false;
+  while (taken < count && take_next(ros_messages[taken], taken, alive)) {
+    took_any = true;
+    if (alive) {
+      ++taken;
+    }
+  }
+  if (took_any) {
+    data_taken();
+  }
+  return taken;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__TAKE_SEQUENCE_HPP_
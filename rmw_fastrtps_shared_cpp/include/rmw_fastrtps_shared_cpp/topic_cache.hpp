@@ -15,10 +15,10 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__TOPIC_CACHE_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__TOPIC_CACHE_HPP_
 
-#include <algorithm>
-#include <iterator>
-#include <map>
-#include <set>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -31,75 +31,302 @@
 #include "rcpputils/thread_safety_annotations.hpp"
 #include "rcutils/logging_macros.h"
 
+#include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
+
 typedef eprosima::fastrtps::rtps::GUID_t GUID_t;
 
 /**
  * Topic cache data structure. Manages relationships between participants and topics.
+ *
+ * Topic and type names are interned, each name is stored once and referred to by an id.
+ * Relationships are kept as a number of endpoints per (topic, type) pair, so adding or
+ * removing an endpoint is a few hash lookups and does not allocate strings once the names
+ * have been seen. The interned strings are shared, so they can be kept past the removal of
+ * the last endpoint using them.
  */
 class TopicCache
 {
 private:
-  typedef std::map<GUID_t,
-      std::unordered_map<std::string, std::vector<std::string>>> ParticipantTopicMap;
-  typedef std::unordered_map<std::string, std::vector<std::string>> TopicToTypes;
+  typedef uint32_t NameId;
+  // Topic name id in the upper half, type name id in the lower half
+  typedef uint64_t TopicTypeId;
+  typedef std::unordered_map<TopicTypeId, size_t> TopicTypeCounts;
+
+  struct GUIDHash
+  {
+    size_t operator()(const GUID_t & guid) const
+    {
+      // FNV-1a over the prefix and the entity id
+      uint64_t hash = 14695981039346656037ULL;
+      for (auto octet : guid.guidPrefix.value) {
+        hash = (hash ^ octet) * 1099511628211ULL;
+      }
+      for (auto octet : guid.entityId.value) {
+        hash = (hash ^ octet) * 1099511628211ULL;
+      }
+      return static_cast<size_t>(hash);
+    }
+  };
+
+  typedef std::unordered_map<GUID_t, TopicTypeCounts, GUIDHash> ParticipantTopicMap;
+
+  struct InternedName
+  {
+    std::shared_ptr<const std::string> name;
+    // Number of endpoints using this name as topic or type
+    size_t references;
+  };
+
+  std::unordered_map<std::string, NameId> name_ids_;
+  std::vector<InternedName> names_;
+  std::vector<NameId> free_name_ids_;
 
   /**
-   * Map of topic names to a vector of types that topic may use.
+   * Number of endpoints per topic and type.
    * Topics here are represented as one to many, DDS XTypes 1.2
    * specifies application code 'generally' uses a 1-1 relationship.
    * However, generic services such as logger and monitor, can discover
    * multiple types on the same topic.
-   *
    */
-  TopicToTypes topic_to_types_;
+  TopicTypeCounts topic_type_counts_;
 
   /**
-   * Map of participant GUIDS to a set of topic-type.
+   * Number of endpoints per topic, whatever their type.
+   */
+  std::unordered_map<NameId, size_t> topic_counts_;
+
+  /**
+   * Number of endpoints per ROS topic name, whatever their type.
+   * Topics are counted under their name stripped of its ROS prefix, e.g. "rt/chatter" is
+   * counted under "/chatter", topics without a prefix only if they start with a '/'.
+   */
+  std::unordered_map<std::string, size_t> ros_topic_counts_;
+
+  /**
+   * Map of participant GUIDS to their number of endpoints per topic and type.
    */
   ParticipantTopicMap participant_to_topics_;
 
+  // Reused for the names given by discovery, so that looking them up does not allocate
+  std::string topic_name_buffer_;
+  std::string type_name_buffer_;
+  std::string ros_topic_name_buffer_;
+
+  static TopicTypeId makeTopicTypeId(NameId topic_id, NameId type_id)
+  {
+    return (static_cast<TopicTypeId>(topic_id) << 32) | type_id;
+  }
+
+  const std::string & topicOf(TopicTypeId id) const
+  {
+    return *names_[static_cast<NameId>(id >> 32)].name;
+  }
+
+  const std::string & typeOf(TopicTypeId id) const
+  {
+    return *names_[static_cast<NameId>(id & 0xFFFFFFFF)].name;
+  }
+
+  /**
+   * Helper function to find the id of an interned name.
+   *
+   * @param name
+   * @param id [out] id of the name
+   * @return true if the name is interned
+   */
+  bool findName(const std::string & name, NameId & id) const
+  {
+    auto it = name_ids_.find(name);
+    if (it == name_ids_.end()) {
+      return false;
+    }
+    id = it->second;
+    return true;
+  }
+
   /**
-   * Helper function to initialize a topic vector.
+   * Helper function to intern a name, or take a reference on it if it already is.
+   *
+   * @param name
+   * @return id of the name
+   */
+  NameId acquireName(const std::string & name)
+  {
+    NameId id;
+    if (findName(name, id)) {
+      ++names_[id].references;
+      return id;
+    }
+    if (!free_name_ids_.empty()) {
+      id = free_name_ids_.back();
+      free_name_ids_.pop_back();
+      names_[id].name = std::make_shared<const std::string>(name);
+      names_[id].references = 1;
+    } else {
+      id = static_cast<NameId>(names_.size());
+      names_.push_back(InternedName{std::make_shared<const std::string>(name), 1});
+    }
+    name_ids_.emplace(name, id);
+    return id;
+  }
+
+  /**
+   * Helper function to drop a reference on an interned name, forgetting it with the last one.
+   *
+   * @param id
+   */
+  void releaseName(NameId id)
+  {
+    auto & interned = names_[id];
+    if (--interned.references == 0) {
+      name_ids_.erase(*interned.name);
+      interned.name.reset();
+      free_name_ids_.push_back(id);
+    }
+  }
+
+  /**
+   * Helper function to get the ROS topic name a topic is counted under.
    *
    * @param topic_name
+   * @param ros_topic_name [out] name stripped of its ROS prefix
+   * @return false if the topic is not counted under a ROS topic name
    */
-  void initializeTopic(const std::string & topic_name, TopicToTypes & topic_to_types)
+  static bool getRosTopicName(const std::string & topic_name, std::string & ros_topic_name)
   {
-    if (topic_to_types.find(topic_name) == topic_to_types.end()) {
-      topic_to_types[topic_name] = std::vector<std::string>();
+    for (const auto & prefix : _get_all_ros_prefixes()) {
+      if (topic_name.size() > prefix.size() &&
+        topic_name.compare(0, prefix.size(), prefix) == 0 &&
+        topic_name[prefix.size()] == '/')
+      {
+        ros_topic_name.assign(topic_name, prefix.size(), std::string::npos);
+        return true;
+      }
     }
+    if (!topic_name.empty() && topic_name[0] == '/') {
+      ros_topic_name.assign(topic_name);
+      return true;
+    }
+    return false;
   }
 
   /**
-   * Helper function to initialize the set inside a participant map.
+   * Helper function to decrement a count, removing it when it drops to zero.
    *
-   * @param map
-   * @param guid
+   * @param counts
+   * @param key
+   * @return false if there was no count for the key
    */
-  void initializeParticipantMap(
-    ParticipantTopicMap & map,
-    GUID_t guid)
+  template<typename CountMap, typename Key>
+  static bool decrementCount(CountMap & counts, const Key & key)
   {
-    if (map.find(guid) == map.end()) {
-      map[guid] = TopicToTypes();
+    auto it = counts.find(key);
+    if (it == counts.end()) {
+      return false;
     }
+    if (--it->second == 0) {
+      counts.erase(it);
+    }
+    return true;
   }
 
 public:
+  /// Interned topic or type name, shared with the cache.
+  typedef std::shared_ptr<const std::string> SharedName;
+
+  /**
+   * @param topic_name
+   * @return the number of endpoints on the topic, whatever their type.
+   */
+  size_t getTopicCount(const std::string & topic_name) const
+  {
+    NameId topic_id;
+    if (!findName(topic_name, topic_id)) {
+      return 0;
+    }
+    auto it = topic_counts_.find(topic_id);
+    return it == topic_counts_.end() ? 0 : it->second;
+  }
+
   /**
-   * @return a map of topic name to the vector of topic types used.
+   * @param ros_topic_name fully qualified ROS topic name, without any ROS prefix
+   * @return the number of endpoints on the topic, whatever their type and ROS prefix.
    */
-  const TopicToTypes & getTopicToTypes() const
+  size_t getRosTopicCount(const std::string & ros_topic_name) const
   {
-    return topic_to_types_;
+    auto it = ros_topic_counts_.find(ros_topic_name);
+    return it == ros_topic_counts_.end() ? 0 : it->second;
   }
 
   /**
-   * @return a map of participant guid to the vector of topic names used.
+   * Call `visitor(topic_name, type_name, count)` for every topic and type used by
+   * `count` endpoints.
+   *
+   * @param visitor
    */
-  const ParticipantTopicMap & getParticipantToTopics() const
+  template<typename Visitor>
+  void forEachTopicType(Visitor && visitor) const
   {
-    return participant_to_topics_;
+    for (const auto & topic_type : topic_type_counts_) {
+      visitor(topicOf(topic_type.first), typeOf(topic_type.first), topic_type.second);
+    }
+  }
+
+  /**
+   * Call `visitor(topic_name, type_name, count)` for every topic and type used by
+   * `count` endpoints of a participant.
+   *
+   * @param guid of the participant
+   * @param visitor
+   * @return false if the participant has no known endpoint
+   */
+  template<typename Visitor>
+  bool forEachTopicTypeOf(const GUID_t & guid, Visitor && visitor) const
+  {
+    auto participant = participant_to_topics_.find(guid);
+    if (participant == participant_to_topics_.end()) {
+      return false;
+    }
+    for (const auto & topic_type : participant->second) {
+      visitor(topicOf(topic_type.first), typeOf(topic_type.first), topic_type.second);
+    }
+    return true;
+  }
+
+  /**
+   * Same as forEachTopicTypeOf(), with the interned names.
+   *
+   * @param guid of the participant
+   * @param visitor called as `visitor(shared_topic_name, shared_type_name, count)`
+   * @return false if the participant has no known endpoint
+   */
+  template<typename Visitor>
+  bool forEachSharedTopicTypeOf(const GUID_t & guid, Visitor && visitor) const
+  {
+    auto participant = participant_to_topics_.find(guid);
+    if (participant == participant_to_topics_.end()) {
+      return false;
+    }
+    for (const auto & topic_type : participant->second) {
+      visitor(
+        names_[static_cast<NameId>(topic_type.first >> 32)].name,
+        names_[static_cast<NameId>(topic_type.first & 0xFFFFFFFF)].name,
+        topic_type.second);
+    }
+    return true;
+  }
+
+  /**
+   * Call `visitor(guid)` for every participant with known endpoints.
+   *
+   * @param visitor
+   */
+  template<typename Visitor>
+  void forEachParticipant(Visitor && visitor) const
+  {
+    for (const auto & participant : participant_to_topics_) {
+      visitor(participant.first);
+    }
   }
 
   /**
@@ -108,17 +335,18 @@ public:
    * @param rtpsParticipantKey
    * @param topic_name
    * @param type_name
+   * @param shared_topic_name [out] if not null, interned topic name
+   * @param shared_type_name [out] if not null, interned type name
    * @return true if a change has been recorded
    */
   bool addTopic(
     const eprosima::fastrtps::rtps::InstanceHandle_t & rtpsParticipantKey,
-    const std::string & topic_name,
-    const std::string & type_name)
+    const char * topic_name,
+    const char * type_name,
+    SharedName * shared_topic_name = nullptr,
+    SharedName * shared_type_name = nullptr)
   {
-    initializeTopic(topic_name, topic_to_types_);
     auto guid = iHandle2GUID(rtpsParticipantKey);
-    initializeParticipantMap(participant_to_topics_, guid);
-    initializeTopic(topic_name, participant_to_topics_[guid]);
     if (rcutils_logging_logger_is_enabled_for("rmw_fastrtps_shared_cpp",
       RCUTILS_LOG_SEVERITY_DEBUG))
     {
@@ -127,10 +355,25 @@ public:
       RCUTILS_LOG_DEBUG_NAMED(
         "rmw_fastrtps_shared_cpp",
         "Adding topic '%s' with type '%s' for node '%s'",
-        topic_name.c_str(), type_name.c_str(), guid_stream.str().c_str());
+        topic_name, type_name, guid_stream.str().c_str());
+    }
+    topic_name_buffer_.assign(topic_name);
+    type_name_buffer_.assign(type_name);
+    NameId topic_id = acquireName(topic_name_buffer_);
+    NameId type_id = acquireName(type_name_buffer_);
+    TopicTypeId topic_type_id = makeTopicTypeId(topic_id, type_id);
+    ++topic_type_counts_[topic_type_id];
+    ++topic_counts_[topic_id];
+    if (getRosTopicName(topic_name_buffer_, ros_topic_name_buffer_)) {
+      ++ros_topic_counts_[ros_topic_name_buffer_];
+    }
+    ++participant_to_topics_[guid][topic_type_id];
+    if (shared_topic_name) {
+      *shared_topic_name = names_[topic_id].name;
+    }
+    if (shared_type_name) {
+      *shared_type_name = names_[type_id].name;
     }
-    topic_to_types_[topic_name].push_back(type_name);
-    participant_to_topics_[guid][topic_name].push_back(type_name);
     return true;
   }
 
@@ -140,47 +383,59 @@ public:
    * @param rtpsParticipantKey
    * @param topic_name
    * @param type_name
+   * @param shared_topic_name [out] if not null, interned topic name, still valid if this was
+   *   its last endpoint
+   * @param shared_type_name [out] if not null, interned type name, still valid if this was
+   *   its last endpoint
    * @return true if a change has been recorded
    */
   bool removeTopic(
     const eprosima::fastrtps::rtps::InstanceHandle_t & rtpsParticipantKey,
-    const std::string & topic_name,
-    const std::string & type_name)
+    const char * topic_name,
+    const char * type_name,
+    SharedName * shared_topic_name = nullptr,
+    SharedName * shared_type_name = nullptr)
   {
-    if (topic_to_types_.find(topic_name) == topic_to_types_.end()) {
+    topic_name_buffer_.assign(topic_name);
+    type_name_buffer_.assign(type_name);
+    NameId topic_id;
+    NameId type_id;
+    if (!findName(topic_name_buffer_, topic_id) || !findName(type_name_buffer_, type_id) ||
+      !decrementCount(topic_type_counts_, makeTopicTypeId(topic_id, type_id)))
+    {
       RCUTILS_LOG_DEBUG_NAMED(
         "rmw_fastrtps_shared_cpp",
         "unexpected removal on topic '%s' with type '%s'",
-        topic_name.c_str(), type_name.c_str());
+        topic_name, type_name);
       return false;
     }
-    {
-      auto & type_vec = topic_to_types_[topic_name];
-      type_vec.erase(std::find(type_vec.begin(), type_vec.end(), type_name));
-      if (type_vec.empty()) {
-        topic_to_types_.erase(topic_name);
-      }
+    decrementCount(topic_counts_, topic_id);
+    if (getRosTopicName(topic_name_buffer_, ros_topic_name_buffer_)) {
+      decrementCount(ros_topic_counts_, ros_topic_name_buffer_);
     }
 
     auto guid = iHandle2GUID(rtpsParticipantKey);
     auto guid_topics_pair = participant_to_topics_.find(guid);
     if (guid_topics_pair != participant_to_topics_.end() &&
-      guid_topics_pair->second.find(topic_name) != guid_topics_pair->second.end())
+      decrementCount(guid_topics_pair->second, makeTopicTypeId(topic_id, type_id)))
     {
-      auto & type_vec = guid_topics_pair->second[topic_name];
-      type_vec.erase(std::find(type_vec.begin(), type_vec.end(), type_name));
-      if (type_vec.empty()) {
-        participant_to_topics_[guid].erase(topic_name);
-      }
-      if (participant_to_topics_[guid].empty()) {
-        participant_to_topics_.erase(guid);
+      if (guid_topics_pair->second.empty()) {
+        participant_to_topics_.erase(guid_topics_pair);
       }
     } else {
       RCUTILS_LOG_DEBUG_NAMED(
         "rmw_fastrtps_shared_cpp",
         "Unable to remove topic, does not exist '%s' with type '%s'",
-        topic_name.c_str(), type_name.c_str());
+        topic_name, type_name);
+    }
+    if (shared_topic_name) {
+      *shared_topic_name = names_[topic_id].name;
+    }
+    if (shared_type_name) {
+      *shared_type_name = names_[type_id].name;
     }
+    releaseName(topic_id);
+    releaseName(type_id);
     return true;
   }
 };
@@ -189,27 +444,28 @@ inline std::ostream & operator<<(
   std::ostream & ostream,
   const TopicCache & topic_cache)
 {
+  auto print_topic_type =
+    [](std::ostream & stream, const std::string & topic, const std::string & type, size_t count) {
+      stream << topic << ": " << type << " (" << count << ")" << std::endl;
+    };
   std::stringstream map_ss;
   map_ss << "Participant Info: " << std::endl;
-  for (auto & elem : topic_cache.getParticipantToTopics()) {
-    std::ostringstream stream;
-    stream << "  Topics: " << std::endl;
-    for (auto & types : elem.second) {
-      stream << "    " << types.first << ": ";
-      std::copy(types.second.begin(), types.second.end(),
-        std::ostream_iterator<std::string>(stream, ","));
-      stream << std::endl;
-    }
-    map_ss << elem.first << std::endl << stream.str();
-  }
+  topic_cache.forEachParticipant(
+    [&](const GUID_t & guid) {
+      map_ss << guid << std::endl << "  Topics: " << std::endl;
+      topic_cache.forEachTopicTypeOf(guid,
+        [&](const std::string & topic, const std::string & type, size_t count) {
+          map_ss << "    ";
+          print_topic_type(map_ss, topic, type, count);
+        });
+    });
   std::stringstream topics_ss;
   topics_ss << "Cumulative TopicToTypes: " << std::endl;
-  for (auto & elem : topic_cache.getTopicToTypes()) {
-    std::ostringstream stream;
-    std::copy(elem.second.begin(), elem.second.end(), std::ostream_iterator<std::string>(stream,
-      ","));
-    topics_ss << "  " << elem.first << " : " << stream.str() << std::endl;
-  }
+  topic_cache.forEachTopicType(
+    [&](const std::string & topic, const std::string & type, size_t count) {
+      topics_ss << "  ";
+      print_topic_type(topics_ss, topic, type, count);
+    });
   ostream << map_ss.str() << topics_ss.str();
   return ostream;
 }
@@ -0,0 +1,80 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__TYPESUPPORT_CACHE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__TYPESUPPORT_CACHE_HPP_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rosidl_generator_c/message_type_support_struct.h"
+
+#include "./TypeSupport.hpp"
+#include "./visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Typesupports of the message types (de)serialized outside of any entity.
+/**
+ * Creating a typesupport builds its type name and computes its maximum
+ * serialized size, which is too costly to repeat for every message given to
+ * rmw_serialize() or rmw_deserialize().
+ * A typesupport is created the first time its type is requested and kept as
+ * long as the cache, so it is shared by all the threads (de)serializing that
+ * type.
+ *
+ * Entries are keyed by the address of the type support handle, which has to
+ * remain valid while the cache exists.
+ */
+class TypeSupportCache
+{
+public:
+  using Factory = std::function<TypeSupport * ()>;
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  TypeSupportCache();
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  ~TypeSupportCache();
+
+  TypeSupportCache(const TypeSupportCache &) = delete;
+  TypeSupportCache & operator=(const TypeSupportCache &) = delete;
+
+  /// Get the typesupport of `type_support`, calling `create` if there is none yet.
+  /**
+   * \return the typesupport, or `nullptr` if `create` failed
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  TypeSupport *
+  get(const rosidl_message_type_support_t * type_support, const Factory & create);
+
+  /// Number of typesupports in the cache.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  size_t
+  size();
+
+private:
+  std::mutex mutex_;
+  std::unordered_map<const rosidl_message_type_support_t *, std::unique_ptr<TypeSupport>>
+  typesupports_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__TYPESUPPORT_CACHE_HPP_
@@ -15,9 +15,12 @@
 #include <fastcdr/FastBuffer.h>
 #include <fastcdr/Cdr.h>
 #include <cassert>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "rmw/serialized_message.h"
+
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 namespace rmw_fastrtps_shared_cpp
@@ -62,7 +65,21 @@ bool TypeSupport::serialize(
       payload->max_size);  // Object that manages the raw buffer.
     eprosima::fastcdr::Cdr ser(fastbuffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
       eprosima::fastcdr::Cdr::DDS_CDR);  // Object that serializes the data.
-    if (this->serializeROSmessage(ser_data->data, ser)) {
+    bool serialized = false;
+    if (ser_data->scratch) {
+      std::unique_lock<std::mutex> lock(ser_data->scratch->mutex(), std::try_to_lock);
+      if (lock.owns_lock()) {
+        serialized = this->serializeROSmessageWithScratch(ser_data->data, ser, *ser_data->scratch);
+      } else {
+        // Another thread is publishing with the same publisher, don't wait for it.
+        SerializationScratch local_scratch;
+        serialized = this->serializeROSmessageWithScratch(ser_data->data, ser, local_scratch);
+        ser_data->scratch->count_allocation(local_scratch.allocation_count());
+      }
+    } else {
+      serialized = this->serializeROSmessage(ser_data->data, ser);
+    }
+    if (serialized) {
       payload->encapsulation = ser.endianness() ==
         eprosima::fastcdr::Cdr::BIG_ENDIANNESS ? CDR_BE : CDR_LE;
       payload->length = (uint32_t)ser.getSerializedDataLength();
@@ -82,11 +99,38 @@ bool TypeSupport::deserialize(
 
   auto ser_data = static_cast<SerializedData *>(data);
   if (ser_data->is_cdr_buffer) {
+    if (ser_data->data == nullptr) {
+      // The sample is taken only to be discarded
+      return true;
+    }
+    if (ser_data->is_serialized_message) {
+      // Copied straight into the message of the caller, without an intermediate buffer
+      auto message = static_cast<rmw_serialized_message_t *>(ser_data->data);
+      if (message->buffer_capacity < payload->length) {
+        ser_data->serialized_message_ret = rmw_serialized_message_resize(message, payload->length);
+        if (ser_data->serialized_message_ret != RMW_RET_OK) {
+          return false;
+        }
+      }
+      memcpy(message->buffer, payload->data, payload->length);
+      message->buffer_length = payload->length;
+      return true;
+    }
     auto buffer = static_cast<eprosima::fastcdr::FastBuffer *>(ser_data->data);
-    if (!buffer->reserve(payload->length)) {
-      return false;
+    if (buffer->getBuffer() == nullptr) {
+      // A fresh buffer is allocated with the exact size of the payload
+      if (!buffer->reserve(payload->length)) {
+        return false;
+      }
+    } else {
+      // A recycled buffer only grows when too small
+      size_t buffer_size = buffer->getBufferSize();
+      if (buffer_size < payload->length && !buffer->resize(payload->length - buffer_size)) {
+        return false;
+      }
     }
     memcpy(buffer->getBuffer(), payload->data, payload->length);
+    ser_data->length = payload->length;
     return true;
   }
 
@@ -100,6 +144,13 @@ bool TypeSupport::deserialize(
   return deserializeROSmessage(deser, ser_data->data);
 }
 
+bool TypeSupport::serializeROSmessageWithScratch(
+  const void * ros_message, eprosima::fastcdr::Cdr & ser, SerializationScratch & scratch)
+{
+  (void)scratch;
+  return this->serializeROSmessage(ros_message, ser);
+}
+
 std::function<uint32_t()> TypeSupport::getSerializedSizeProvider(void * data)
 {
   assert(data);
@@ -37,6 +37,9 @@ PubListener::on_offered_deadline_missed(
   offered_deadline_missed_status_.total_count_change += status.total_count_change;
 
   deadline_changes_.store(true, std::memory_order_relaxed);
+  if (readyQueue_ != nullptr) {
+    readyQueue_->push(readyToken_);
+  }
 }
 
 void PubListener::on_liveliness_lost(
@@ -55,6 +58,9 @@ void PubListener::on_liveliness_lost(
   liveliness_lost_status_.total_count_change += status.total_count_change;
 
   liveliness_changes_.store(true, std::memory_order_relaxed);
+  if (readyQueue_ != nullptr) {
+    readyQueue_->push(readyToken_);
+  }
 }
 
 bool PubListener::hasEvent(rmw_event_type_t event_type) const
@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcpputils/find_and_replace.hpp"
@@ -150,3 +153,27 @@ _demangle_service_type_only(const std::string & dds_type_name)
   std::string type_name = dds_type_name.substr(start, suffix_position - start);
   return type_namespace + type_name;
 }
+
+/// Append the names with their types, demangled as ROS topics and types if `demangle` is true.
+void
+_append_names_and_types(
+  const std::map<std::string, std::set<std::string>> & names_to_types,
+  bool demangle,
+  std::vector<std::pair<std::string, std::vector<std::string>>> & names_and_types)
+{
+  names_and_types.reserve(names_and_types.size() + names_to_types.size());
+  for (const auto & name_n_types : names_to_types) {
+    if (!demangle) {
+      names_and_types.emplace_back(
+        name_n_types.first,
+        std::vector<std::string>(name_n_types.second.begin(), name_n_types.second.end()));
+      continue;
+    }
+    std::vector<std::string> types;
+    types.reserve(name_n_types.second.size());
+    for (const auto & type : name_n_types.second) {
+      types.push_back(_demangle_if_ros_type(type));
+    }
+    names_and_types.emplace_back(_demangle_if_ros_topic(name_n_types.first), std::move(types));
+  }
+}
@@ -15,7 +15,11 @@
 #ifndef DEMANGLE_HPP_
 #define DEMANGLE_HPP_
 
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 /// Return the demangle ROS topic or the original if not a ROS topic.
 std::string
@@ -33,4 +37,11 @@ _demangle_service_from_topic(const std::string & topic_name);
 std::string
 _demangle_service_type_only(const std::string & dds_type_name);
 
+/// Append the names with their types, demangled as ROS topics and types if `demangle` is true.
+void
+_append_names_and_types(
+  const std::map<std::string, std::set<std::string>> & names_to_types,
+  bool demangle,
+  std::vector<std::pair<std::string, std::vector<std::string>>> & names_and_types);
+
 #endif  // DEMANGLE_HPP_
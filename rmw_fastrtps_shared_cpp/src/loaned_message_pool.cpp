@@ -0,0 +1,105 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
+
+#include <new>
+#include <utility>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+LoanedMessagePool::LoanedMessagePool(
+  size_t message_size,
+  MessageFunction init,
+  MessageFunction fini,
+  size_t preallocated)
+: message_size_(message_size > 0 ? message_size : 1),
+  init_(std::move(init)),
+  fini_(std::move(fini))
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_slots_.reserve(preallocated);
+  for (size_t i = 0; i < preallocated; ++i) {
+    void * slot = ::operator new(message_size_, std::nothrow);
+    if (!slot) {
+      break;
+    }
+    free_slots_.push_back(slot);
+  }
+}
+
+LoanedMessagePool::~LoanedMessagePool()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (void * slot : free_slots_) {
+    ::operator delete(slot);
+  }
+  // Loans still out at this point belong to an entity being destroyed.
+  for (void * slot : lent_slots_) {
+    if (fini_) {
+      fini_(slot);
+    }
+    ::operator delete(slot);
+  }
+}
+
+void *
+LoanedMessagePool::borrow()
+{
+  void * slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_slots_.empty()) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      slot = ::operator new(message_size_, std::nothrow);
+      if (!slot) {
+        return nullptr;
+      }
+    }
+    lent_slots_.insert(slot);
+  }
+  if (init_) {
+    init_(slot);
+  }
+  return slot;
+}
+
+bool
+LoanedMessagePool::give_back(void * message)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (lent_slots_.erase(message) == 0) {
+      return false;
+    }
+  }
+  if (fini_) {
+    fini_(message);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_slots_.push_back(message);
+  return true;
+}
+
+bool
+LoanedMessagePool::is_lent(const void * message)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return lent_slots_.count(const_cast<void *>(message)) != 0;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
@@ -26,6 +26,8 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "types/custom_wait_set_info.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -60,6 +62,7 @@ __rmw_destroy_client(
       delete info->pub_listener_;
     }
     if (info->listener_ != nullptr) {
+      detach_from_wait_sets(info->listener_);
       delete info->listener_;
     }
     if (info->request_type_support_ != nullptr) {
@@ -78,4 +81,26 @@ __rmw_destroy_client(
 
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_client_set_on_new_response_callback(
+  const char * identifier,
+  rmw_client_t * client,
+  void (* callback)(const void * user_data, size_t number_of_responses),
+  const void * user_data)
+{
+  if (!client) {
+    RMW_SET_ERROR_MSG("client handle is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("client handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  info->listener_->setResponseCallback(callback, user_data);
+
+  return RMW_RET_OK;
+}
 }  // namespace rmw_fastrtps_shared_cpp
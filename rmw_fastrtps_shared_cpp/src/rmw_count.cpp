@@ -52,31 +52,19 @@ __rmw_count_publishers(
   }
 
 
-  auto ros_prefixes = _get_all_ros_prefixes();
-
-  // Build the list of all possible topic FQDN
-  std::vector<std::string> topic_fqdns;
-  topic_fqdns.push_back(topic_name);
-  if (topic_name[0] == '/') {
-    std::for_each(ros_prefixes.begin(), ros_prefixes.end(),
-      [&topic_fqdns, &topic_name](const std::string & prefix) {
-        topic_fqdns.push_back(prefix + topic_name);
-      });
-  }
+  // Names starting with a '/' are ROS topic names, counted whatever their ROS prefix
+  const bool is_ros_topic = topic_name[0] == '/';
+  const std::string topic_name_str(topic_name);
 
   auto impl = static_cast<CustomParticipantInfo *>(node->data);
   *count = 0;
   ::ParticipantListener * slave_target = impl->listener;
   {
     std::lock_guard<std::mutex> guard(slave_target->writer_topic_cache.getMutex());
-    // Search and sum up the publisher counts
-    auto & topic_types = slave_target->writer_topic_cache().getTopicToTypes();
-    for (const auto & topic_fqdn : topic_fqdns) {
-      const auto & it = topic_types.find(topic_fqdn);
-      if (it != topic_types.end()) {
-        *count += it->second.size();
-      }
-    }
+    auto & topic_cache = slave_target->writer_topic_cache();
+    *count = is_ros_topic ?
+      topic_cache.getRosTopicCount(topic_name_str) :
+      topic_cache.getTopicCount(topic_name_str);
   }
 
   RCUTILS_LOG_DEBUG_NAMED(
@@ -107,31 +95,19 @@ __rmw_count_subscribers(
   }
 
 
-  auto ros_prefixes = _get_all_ros_prefixes();
-
-  // Build the list of all possible topic FQDN
-  std::vector<std::string> topic_fqdns;
-  topic_fqdns.push_back(topic_name);
-  if (topic_name[0] == '/') {
-    std::for_each(ros_prefixes.begin(), ros_prefixes.end(),
-      [&topic_fqdns, &topic_name](const std::string & prefix) {
-        topic_fqdns.push_back(prefix + topic_name);
-      });
-  }
+  // Names starting with a '/' are ROS topic names, counted whatever their ROS prefix
+  const bool is_ros_topic = topic_name[0] == '/';
+  const std::string topic_name_str(topic_name);
 
   CustomParticipantInfo * impl = static_cast<CustomParticipantInfo *>(node->data);
   *count = 0;
   ::ParticipantListener * slave_target = impl->listener;
   {
     std::lock_guard<std::mutex> guard(slave_target->reader_topic_cache.getMutex());
-    // Search and sum up the subscriber counts
-    auto & topic_types = slave_target->reader_topic_cache().getTopicToTypes();
-    for (const auto & topic_fqdn : topic_fqdns) {
-      const auto & it = topic_types.find(topic_fqdn);
-      if (it != topic_types.end()) {
-        *count += it->second.size();
-      }
-    }
+    auto & topic_cache = slave_target->reader_topic_cache();
+    *count = is_ros_topic ?
+      topic_cache.getRosTopicCount(topic_name_str) :
+      topic_cache.getTopicCount(topic_name_str);
   }
 
   RCUTILS_LOG_DEBUG_NAMED(
@@ -17,6 +17,7 @@
 
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
+#include "types/custom_wait_set_info.hpp"
 #include "types/guard_condition.hpp"
 
 namespace rmw_fastrtps_shared_cpp
@@ -34,7 +35,9 @@ rmw_ret_t
 __rmw_destroy_guard_condition(rmw_guard_condition_t * guard_condition)
 {
   if (guard_condition) {
-    delete static_cast<GuardCondition *>(guard_condition->data);
+    auto guard_condition_impl = static_cast<GuardCondition *>(guard_condition->data);
+    detach_from_wait_sets(guard_condition_impl);
+    delete guard_condition_impl;
     delete guard_condition;
     return RMW_RET_OK;
   }
@@ -13,9 +13,12 @@
 // limitations under the License.
 
 #include <array>
+#include <chrono>
+#include <cstdlib>
 #include <utility>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "rcutils/filesystem.h"
 #include "rcutils/logging_macros.h"
@@ -58,6 +61,38 @@ using StatefulReader = eprosima::fastrtps::rtps::StatefulReader;
 
 namespace rmw_fastrtps_shared_cpp
 {
+// Read the minimum delay between two triggers of the graph guard condition from the
+// RMW_FASTRTPS_GRAPH_COALESCING_MS env variable, zero (no delay) if unset or invalid.
+static
+std::chrono::milliseconds
+get_graph_coalescing_window()
+{
+  const char * env_var = "RMW_FASTRTPS_GRAPH_COALESCING_MS";
+  std::chrono::milliseconds window(0);
+  char * config_env_val = nullptr;
+#ifndef _WIN32
+  config_env_val = getenv(env_var);
+#else
+  size_t config_env_val_size;
+  _dupenv_s(&config_env_val, &config_env_val_size, env_var);
+#endif
+  if (config_env_val != nullptr && config_env_val[0] != '\0') {
+    char * end = nullptr;
+    uint64_t value = strtoull(config_env_val, &end, 10);
+    if (config_env_val[0] >= '0' && config_env_val[0] <= '9' && *end == '\0') {
+      window = std::chrono::milliseconds(value);
+    } else {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "ignoring invalid value '%s' of %s", config_env_val, env_var);
+    }
+  }
+#ifdef _WIN32
+  free(config_env_val);
+#endif
+  return window;
+}
+
 rmw_node_t *
 create_node(
   const char * identifier,
@@ -89,7 +124,7 @@ create_node(
   }
 
   try {
-    listener = new ::ParticipantListener(graph_guard_condition);
+    listener = new ::ParticipantListener(graph_guard_condition, get_graph_coalescing_window());
   } catch (std::bad_alloc &) {
     RMW_SET_ERROR_MSG("failed to allocate participant listener");
     goto fail;
@@ -367,13 +402,15 @@ __rmw_destroy_node(
 
   Domain::removeParticipant(participant);
 
+  // The listener may still trigger the graph guard condition until it is deleted
+  delete impl->listener;
+  impl->listener = nullptr;
+
   if (RMW_RET_OK != __rmw_destroy_guard_condition(impl->graph_guard_condition)) {
     RMW_SET_ERROR_MSG("failed to destroy graph guard condition");
     result_ret = RMW_RET_ERROR;
   }
 
-  delete impl->listener;
-  impl->listener = nullptr;
   delete impl;
 
   return result_ret;
@@ -415,4 +452,47 @@ __rmw_node_get_graph_guard_condition(const rmw_node_t * node)
   }
   return impl->graph_guard_condition;
 }
+
+rmw_ret_t
+__rmw_get_graph_changes(
+  const char * identifier,
+  const rmw_node_t * node,
+  uint64_t sequence,
+  std::vector<GraphChange> * changes,
+  bool * resync_needed)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    node,
+    node->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(changes, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(resync_needed, RMW_RET_INVALID_ARGUMENT);
+
+  auto impl = static_cast<CustomParticipantInfo *>(node->data);
+  *resync_needed = !impl->listener->get_graph_changes_since(sequence, *changes);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_get_graph_endpoints(
+  const char * identifier,
+  const rmw_node_t * node,
+  std::vector<GraphChange> * endpoints,
+  uint64_t * sequence)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    node,
+    node->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(endpoints, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(sequence, RMW_RET_INVALID_ARGUMENT);
+
+  auto impl = static_cast<CustomParticipantInfo *>(node->data);
+  *sequence = impl->listener->get_graph_endpoints(*endpoints);
+  return RMW_RET_OK;
+}
 }  // namespace rmw_fastrtps_shared_cpp
@@ -17,6 +17,7 @@
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "rcutils/allocator.h"
 #include "rcutils/error_handling.h"
@@ -62,25 +63,11 @@ rmw_ret_t __get_guid_by_name(
   if (strcmp(node->name, node_name) == 0 && strcmp(node->namespace_, node_namespace) == 0) {
     guid = impl->participant->getGuid();
   } else {
-    std::set<GUID_t> nodes_in_desired_namespace;
-    std::lock_guard<std::mutex> guard(impl->listener->names_mutex_);
+    auto discovered_nodes = impl->listener->get_discovered_nodes();
+    auto guid_node_pair = discovered_nodes->guids_by_name.find(
+      std::make_pair(std::string(node_namespace), std::string(node_name)));
 
-    auto namespaces = impl->listener->discovered_namespaces;
-    for (auto & guid_to_namespace : impl->listener->discovered_namespaces) {
-      if (guid_to_namespace.second == node_namespace) {
-        nodes_in_desired_namespace.insert(guid_to_namespace.first);
-      }
-    }
-
-    auto guid_node_pair = std::find_if(impl->listener->discovered_names.begin(),
-        impl->listener->discovered_names.end(),
-        [node_name, &nodes_in_desired_namespace](const std::pair<const GUID_t,
-        std::string> & pair) {
-          return pair.second == node_name &&
-          nodes_in_desired_namespace.find(pair.first) != nodes_in_desired_namespace.end();
-        });
-
-    if (guid_node_pair == impl->listener->discovered_names.end()) {
+    if (guid_node_pair == discovered_nodes->guids_by_name.end()) {
       RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
         "Node name not found: ns='%s', name='%s'",
         node_namespace,
@@ -88,7 +75,7 @@ rmw_ret_t __get_guid_by_name(
       );
       return RMW_RET_NODE_NAME_NON_EXISTENT;
     }
-    guid = guid_node_pair->first;
+    guid = guid_node_pair->second.guid;
   }
   return RMW_RET_OK;
 }
@@ -158,25 +145,23 @@ __accumulate_topics(
   bool no_demangle)
 {
   std::lock_guard<std::mutex> guard(topic_cache.getMutex());
-  const auto & node_topics = topic_cache().getParticipantToTopics().find(node_guid_);
-  if (node_topics == topic_cache().getParticipantToTopics().end()) {
+  bool found = topic_cache().forEachTopicTypeOf(node_guid_,
+      [&topics, no_demangle](const std::string & topic, const std::string & type, size_t) {
+        if (!no_demangle && _get_ros_prefix_if_exists(topic) != ros_topic_prefix) {
+          // if we are demangling and this is not prefixed with rt/, skip it
+          return;
+        }
+        RCUTILS_LOG_DEBUG_NAMED(
+          kLoggerTag,
+          "accumulate_topics: Found topic %s",
+          topic.c_str());
+
+        topics[topic].insert(type);
+      });
+  if (!found) {
     RCUTILS_LOG_DEBUG_NAMED(
       kLoggerTag,
       "No topics found for node");
-    return;
-  }
-  for (auto & topic_pair : node_topics->second) {
-    if (!no_demangle && _get_ros_prefix_if_exists(topic_pair.first) != ros_topic_prefix) {
-      // if we are demangling and this is not prefixed with rt/, skip it
-      continue;
-    }
-    RCUTILS_LOG_DEBUG_NAMED(
-      kLoggerTag,
-      "accumulate_topics: Found topic %s",
-      topic_pair.first.c_str());
-
-    topics[topic_pair.first].insert(topic_pair.second.begin(),
-      topic_pair.second.end());
   }
 }
 
@@ -185,15 +170,13 @@ __accumulate_topics(
  *
  * @param topics to copy over
  * @param allocator to use
- * @param no_demangle true if demangling will not occur
  * @param topic_names_and_types [out] final rmw result
  * @return RMW_RET_OK if successful
  */
 rmw_ret_t
 __copy_data_to_results(
-  const std::map<std::string, std::set<std::string>> & topics,
+  const ::ParticipantListener::NamesAndTypes & topics,
   rcutils_allocator_t * allocator,
-  bool no_demangle,
   rmw_names_and_types_t * topic_names_and_types)
 {
   // Copy data to results handle
@@ -212,21 +195,11 @@ __copy_data_to_results(
             "error during report of error: %s", rmw_get_error_string().str);
         }
       };
-    // Setup demangling functions based on no_demangle option
-    auto demangle_topic = _demangle_if_ros_topic;
-    auto demangle_type = _demangle_if_ros_type;
-    if (no_demangle) {
-      auto noop = [](const std::string & in) {
-          return in;
-        };
-      demangle_topic = noop;
-      demangle_type = noop;
-    }
     // For each topic, store the name, initialize the string array for types, and store all types
     size_t index = 0;
     for (const auto & topic_n_types : topics) {
       // Duplicate and store the topic_name
-      char * topic_name = rcutils_strdup(demangle_topic(topic_n_types.first).c_str(), *allocator);
+      char * topic_name = rcutils_strdup(topic_n_types.first.c_str(), *allocator);
       if (!topic_name) {
         RMW_SET_ERROR_MSG("failed to allocate memory for topic name");
         fail_cleanup();
@@ -248,7 +221,7 @@ __copy_data_to_results(
       // Duplicate and store each type for the topic
       size_t type_index = 0;
       for (const auto & type : topic_n_types.second) {
-        char * type_name = rcutils_strdup(demangle_type(type).c_str(), *allocator);
+        char * type_name = rcutils_strdup(type.c_str(), *allocator);
         if (!type_name) {
           RMW_SET_ERROR_MSG("failed to allocate memory for type name");
           fail_cleanup();
@@ -286,20 +259,16 @@ __log_debug_information(const CustomParticipantInfo & impl)
         "Subscriber Topic cache is: %s", map_ss.str().c_str());
     }
     {
-      std::stringstream ss;
-      std::lock_guard<std::mutex> guard(impl.listener->names_mutex_);
-      for (auto & node_pair : impl.listener->discovered_names) {
-        ss << node_pair.first << " : " << node_pair.second << " ";
-      }
-      RCUTILS_LOG_DEBUG_NAMED(kLoggerTag, "Discovered names: %s", ss.str().c_str());
-    }
-    {
-      std::stringstream ss;
-      std::lock_guard<std::mutex> guard(impl.listener->names_mutex_);
-      for (auto & node_pair : impl.listener->discovered_namespaces) {
-        ss << node_pair.first << " : " << node_pair.second << " ";
+      std::stringstream names_ss;
+      std::stringstream namespaces_ss;
+      auto discovered_nodes = impl.listener->get_discovered_nodes();
+      for (auto & node_pair : discovered_nodes->nodes) {
+        names_ss << node_pair.first << " : " << node_pair.second.name << " ";
+        namespaces_ss << node_pair.first << " : " << node_pair.second.namespace_ << " ";
       }
-      RCUTILS_LOG_DEBUG_NAMED(kLoggerTag, "Discovered namespaces: %s", ss.str().c_str());
+      RCUTILS_LOG_DEBUG_NAMED(kLoggerTag, "Discovered names: %s", names_ss.str().c_str());
+      RCUTILS_LOG_DEBUG_NAMED(
+        kLoggerTag, "Discovered namespaces: %s", namespaces_ss.str().c_str());
     }
   }
 }
@@ -320,6 +289,7 @@ typedef std::function<const LockedObject<TopicCache>&(CustomParticipantInfo & pa
  * @param node_namespace to search
  * @param no_demangle true if the topics should not be demangled
  * @param retrieve_cache_func getter for topic cache
+ * @param query identifying the cached result of this function
  * @param topic_names_and_types result
  * @return RMW_RET_OK if successful
  */
@@ -332,6 +302,7 @@ __rmw_get_topic_names_and_types_by_node(
   const char * node_namespace,
   bool no_demangle,
   RetrieveCache & retrieve_cache_func,
+  ::ParticipantListener::GraphQuery query,
   rmw_names_and_types_t * topic_names_and_types)
 {
   rmw_ret_t valid_input = __validate_input(identifier, node, allocator, node_name,
@@ -349,9 +320,14 @@ __rmw_get_topic_names_and_types_by_node(
   if (valid_guid != RMW_RET_OK) {
     return valid_guid;
   }
-  std::map<std::string, std::set<std::string>> topics;
-  __accumulate_topics(retrieve_cache_func(*impl), topics, guid, no_demangle);
-  return __copy_data_to_results(topics, allocator, no_demangle, topic_names_and_types);
+  auto topics = impl->listener->get_graph_snapshot(query, guid,
+      [impl, &retrieve_cache_func, &guid, no_demangle](
+        ::ParticipantListener::NamesAndTypes & names_and_types) {
+        std::map<std::string, std::set<std::string>> topics;
+        __accumulate_topics(retrieve_cache_func(*impl), topics, guid, no_demangle);
+        _append_names_and_types(topics, !no_demangle, names_and_types);
+      });
+  return __copy_data_to_results(*topics, allocator, topic_names_and_types);
 }
 
 rmw_ret_t
@@ -369,7 +345,11 @@ __rmw_get_subscriber_names_and_types_by_node(
       return participant_info.listener->reader_topic_cache;
     };
   return __rmw_get_topic_names_and_types_by_node(identifier, node, allocator, node_name,
-           node_namespace, no_demangle, retrieve_sub_cache, topic_names_and_types);
+           node_namespace, no_demangle, retrieve_sub_cache,
+           no_demangle ?
+           ::ParticipantListener::GraphQuery::NODE_SUBSCRIBERS_NO_DEMANGLE :
+           ::ParticipantListener::GraphQuery::NODE_SUBSCRIBERS,
+           topic_names_and_types);
 }
 
 rmw_ret_t
@@ -387,7 +367,57 @@ __rmw_get_publisher_names_and_types_by_node(
       return participant_info.listener->writer_topic_cache;
     };
   return __rmw_get_topic_names_and_types_by_node(identifier, node, allocator, node_name,
-           node_namespace, no_demangle, retrieve_pub_cache, topic_names_and_types);
+           node_namespace, no_demangle, retrieve_pub_cache,
+           no_demangle ?
+           ::ParticipantListener::GraphQuery::NODE_PUBLISHERS_NO_DEMANGLE :
+           ::ParticipantListener::GraphQuery::NODE_PUBLISHERS,
+           topic_names_and_types);
+}
+
+/**
+ * Gather the names and types of the services served, or used, by a node.
+ *
+ * @param impl participant which discovered the node
+ * @param guid of the node
+ * @param topic_suffix suffix of the service topics the node subscribes to
+ * @param names_and_types [out] names and types, in the order they are reported
+ */
+static
+void
+__gather_services_by_node(
+  const CustomParticipantInfo & impl,
+  const GUID_t & guid,
+  const std::string & topic_suffix,
+  ::ParticipantListener::NamesAndTypes & names_and_types)
+{
+  std::map<std::string, std::set<std::string>> services;
+  {
+    auto & topic_cache = impl.listener->reader_topic_cache;
+    std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+    topic_cache().forEachTopicTypeOf(guid,
+      [&services, &topic_suffix](
+        const std::string & topic_name, const std::string & type, size_t) {
+        std::string service_name = _demangle_service_from_topic(topic_name);
+        if (service_name.empty()) {
+          // not a service
+          return;
+        }
+        // Check if the topic suffix matches and is at the end of the name
+        auto suffix_position = topic_name.rfind(topic_suffix);
+        if (suffix_position == std::string::npos ||
+          topic_name.length() - suffix_position - topic_suffix.length() != 0)
+        {
+          return;
+        }
+
+        std::string service_type = _demangle_service_type_only(type);
+        if (!service_type.empty()) {
+          services[service_name].insert(service_type);
+        }
+      });
+  }
+  // The service names and types are demangled already
+  _append_names_and_types(services, false, names_and_types);
 }
 
 static
@@ -399,7 +429,8 @@ __get_service_names_and_types_by_node(
   const char * node_name,
   const char * node_namespace,
   rmw_names_and_types_t * service_names_and_types,
-  const char * topic_suffix)
+  const char * topic_suffix,
+  ::ParticipantListener::GraphQuery query)
 {
   const std::string topic_suffix_stdstr(topic_suffix);
   rmw_ret_t valid_input = __validate_input(identifier, node, allocator, node_name,
@@ -416,42 +447,16 @@ __get_service_names_and_types_by_node(
     return valid_guid;
   }
 
-  std::map<std::string, std::set<std::string>> services;
-  {
-    auto & topic_cache = impl->listener->reader_topic_cache;
-    std::lock_guard<std::mutex> guard(topic_cache.getMutex());
-    const auto & node_topics = topic_cache().getParticipantToTopics().find(guid);
-    if (node_topics != topic_cache().getParticipantToTopics().end()) {
-      for (auto & topic_pair : node_topics->second) {
-        std::string service_name = _demangle_service_from_topic(topic_pair.first);
-        if (service_name.empty()) {
-          // not a service
-          continue;
-        }
-        // Check if the topic suffix matches and is at the end of the name
-        const std::string & topic_name = topic_pair.first;
-        auto suffix_position = topic_name.rfind(topic_suffix_stdstr);
-        if (suffix_position == std::string::npos ||
-          topic_name.length() - suffix_position - topic_suffix_stdstr.length() != 0)
-        {
-          continue;
-        }
-
-        for (auto & itt : topic_pair.second) {
-          std::string service_type = _demangle_service_type_only(itt);
-          if (!service_type.empty()) {
-            services[service_name].insert(service_type);
-          }
-        }
-      }
-    }
-  }
-  if (services.empty()) {
+  auto services = impl->listener->get_graph_snapshot(query, guid,
+      [impl, &guid, &topic_suffix_stdstr](::ParticipantListener::NamesAndTypes & names_and_types) {
+        __gather_services_by_node(*impl, guid, topic_suffix_stdstr, names_and_types);
+      });
+  if (services->empty()) {
     return RMW_RET_OK;
   }
   // Setup string array to store names
   rmw_ret_t rmw_ret =
-    rmw_names_and_types_init(service_names_and_types, services.size(), allocator);
+    rmw_names_and_types_init(service_names_and_types, services->size(), allocator);
   if (rmw_ret != RMW_RET_OK) {
     return rmw_ret;
   }
@@ -466,7 +471,7 @@ __get_service_names_and_types_by_node(
     };
   // For each service, store the name, initialize the string array for types, and store all types
   size_t index = 0;
-  for (const auto & service_n_types : services) {
+  for (const auto & service_n_types : *services) {
     // Duplicate and store the service_name
     char * service_name = rcutils_strdup(service_n_types.first.c_str(), *allocator);
     if (!service_name) {
@@ -518,7 +523,8 @@ __rmw_get_service_names_and_types_by_node(
     node_name,
     node_namespace,
     service_names_and_types,
-    "Request");
+    "Request",
+    ::ParticipantListener::GraphQuery::NODE_SERVICES);
 }
 
 rmw_ret_t
@@ -537,7 +543,8 @@ __rmw_get_client_names_and_types_by_node(
     node_name,
     node_namespace,
     service_names_and_types,
-    "Reply");
+    "Reply",
+    ::ParticipantListener::GraphQuery::NODE_CLIENTS);
 }
 
 }  // namespace rmw_fastrtps_shared_cpp
@@ -59,31 +59,32 @@ __rmw_get_node_names(
   }
 
   auto impl = static_cast<CustomParticipantInfo *>(node->data);
-  auto participant_names = impl->listener->get_discovered_names();
-  auto participant_ns = impl->listener->get_discovered_namespaces();
+  auto discovered_nodes = impl->listener->get_discovered_nodes();
+  auto participant = discovered_nodes->nodes.begin();
 
   rcutils_allocator_t allocator = rcutils_get_default_allocator();
   rcutils_ret_t rcutils_ret =
-    rcutils_string_array_init(node_names, participant_names.size() + 1, &allocator);
+    rcutils_string_array_init(node_names, discovered_nodes->nodes.size() + 1, &allocator);
   if (rcutils_ret != RCUTILS_RET_OK) {
     RMW_SET_ERROR_MSG(rcutils_get_error_string().str);
     goto fail;
   }
 
   rcutils_ret =
-    rcutils_string_array_init(node_namespaces, participant_names.size() + 1, &allocator);
+    rcutils_string_array_init(node_namespaces, discovered_nodes->nodes.size() + 1, &allocator);
   if (rcutils_ret != RCUTILS_RET_OK) {
     RMW_SET_ERROR_MSG(rcutils_get_error_string().str);
     goto fail;
   }
 
-  for (size_t i = 0; i < participant_names.size() + 1; ++i) {
+  for (size_t i = 0; i < discovered_nodes->nodes.size() + 1; ++i) {
     if (0 == i) {
       node_names->data[i] = rcutils_strdup(node->name, allocator);
       node_namespaces->data[i] = rcutils_strdup(node->namespace_, allocator);
     } else {
-      node_names->data[i] = rcutils_strdup(participant_names[i - 1].c_str(), allocator);
-      node_namespaces->data[i] = rcutils_strdup(participant_ns[i - 1].c_str(), allocator);
+      node_names->data[i] = rcutils_strdup(participant->second.name.c_str(), allocator);
+      node_namespaces->data[i] = rcutils_strdup(participant->second.namespace_.c_str(), allocator);
+      ++participant;
     }
     if (!node_names->data[i] || !node_namespaces->data[i]) {
       RMW_SET_ERROR_MSG("failed to allocate memory for node name");
@@ -48,6 +48,7 @@ __rmw_publish(
   rmw_fastrtps_shared_cpp::SerializedData data;
   data.is_cdr_buffer = false;
   data.data = const_cast<void *>(ros_message);
+  data.scratch = &info->serialization_scratch_;
   if (!info->publisher_->write(&data)) {
     RMW_SET_ERROR_MSG("cannot publish data");
     return RMW_RET_ERROR;
@@ -95,4 +96,38 @@ __rmw_publish_serialized_message(
 
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_publish_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * ros_message,
+  rmw_publisher_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(publisher, "publisher pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_message, "ros_message pointer is null", return RMW_RET_ERROR);
+
+  if (publisher->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "publisher info pointer is null", return RMW_RET_ERROR);
+  if (!publisher->can_loan_messages || !info->loan_pool_) {
+    RMW_SET_ERROR_MSG("publisher cannot loan messages of its type");
+    return RMW_RET_UNSUPPORTED;
+  }
+  if (!info->loan_pool_->is_lent(ros_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned by this publisher");
+    return RMW_RET_ERROR;
+  }
+
+  // Fast-RTPS serializes into its own history, after which the message is owned
+  // by the middleware again whatever the outcome.
+  rmw_ret_t ret = __rmw_publish(identifier, publisher, ros_message, allocation);
+  info->loan_pool_->give_back(ros_message);
+  return ret;
+}
 }  // namespace rmw_fastrtps_shared_cpp
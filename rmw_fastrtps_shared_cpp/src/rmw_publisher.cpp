@@ -29,6 +29,8 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "types/custom_wait_set_info.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 
@@ -66,6 +68,7 @@ __rmw_destroy_publisher(
       Domain::removePublisher(info->publisher_);
     }
     if (info->listener_ != nullptr) {
+      detach_from_wait_sets(info->listener_);
       delete info->listener_;
     }
     if (info->type_support_ != nullptr) {
@@ -148,4 +151,81 @@ __rmw_publisher_get_actual_qos(
 
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_borrow_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const rosidl_message_type_support_t * type_support,
+  void ** ros_message)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+  if (nullptr != *ros_message) {
+    RMW_SET_ERROR_MSG("ros_message is not null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  if (nullptr == info) {
+    RMW_SET_ERROR_MSG("publisher internal data is invalid");
+    return RMW_RET_ERROR;
+  }
+  if (!publisher->can_loan_messages || !info->loan_pool_) {
+    RMW_SET_ERROR_MSG("publisher cannot loan messages of its type");
+    return RMW_RET_UNSUPPORTED;
+  }
+  // The slots of the pool only fit messages of the type of the publisher
+  if (get_message_typesupport_handle(
+      type_support, info->loan_type_support_->typesupport_identifier) != info->loan_type_support_)
+  {
+    RMW_SET_ERROR_MSG("type support does not match the type of the publisher");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  void * message = info->loan_pool_->borrow();
+  if (nullptr == message) {
+    RMW_SET_ERROR_MSG("failed to allocate loaned message");
+    return RMW_RET_BAD_ALLOC;
+  }
+  *ros_message = message;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_return_loaned_message_from_publisher(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * loaned_message)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  if (nullptr == info) {
+    RMW_SET_ERROR_MSG("publisher internal data is invalid");
+    return RMW_RET_ERROR;
+  }
+  if (!publisher->can_loan_messages || !info->loan_pool_) {
+    RMW_SET_ERROR_MSG("publisher cannot loan messages of its type");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  if (!info->loan_pool_->give_back(loaned_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned by this publisher");
+    return RMW_RET_ERROR;
+  }
+  return RMW_RET_OK;
+}
 }  // namespace rmw_fastrtps_shared_cpp
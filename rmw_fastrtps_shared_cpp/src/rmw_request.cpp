@@ -92,9 +92,11 @@ __rmw_take_request(
   CustomServiceRequest request = info->listener_->getRequest();
 
   if (request.buffer_ != nullptr) {
-    eprosima::fastcdr::Cdr deser(*request.buffer_, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+    // Only the bytes of this request, a recycled buffer may hold more from earlier ones
+    eprosima::fastcdr::FastBuffer payload(request.buffer_->getBuffer(), request.length_);
+    eprosima::fastcdr::Cdr deser(payload, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
       eprosima::fastcdr::Cdr::DDS_CDR);
-    info->request_type_support_->deserializeROSmessage(deser, ros_request);
+    bool deserialized = info->request_type_support_->deserializeROSmessage(deser, ros_request);
 
     // Get header
     memcpy(request_header->writer_guid, &request.sample_identity_.writer_guid(),
@@ -102,9 +104,9 @@ __rmw_take_request(
     request_header->sequence_number = ((int64_t)request.sample_identity_.sequence_number().high) <<
       32 | request.sample_identity_.sequence_number().low;
 
-    delete request.buffer_;
+    info->listener_->releaseBuffer(request.buffer_);
 
-    *taken = true;
+    *taken = deserialized;
   }
 
   return RMW_RET_OK;
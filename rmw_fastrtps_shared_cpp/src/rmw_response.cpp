@@ -15,6 +15,7 @@
 #include <cassert>
 
 #include "fastcdr/Cdr.h"
+#include "fastcdr/FastBuffer.h"
 
 #include "fastrtps/subscriber/Subscriber.h"
 
@@ -28,6 +29,32 @@
 
 namespace rmw_fastrtps_shared_cpp
 {
+namespace
+{
+// Deserialize a taken response and give its buffer back, `false` if it could not be deserialized.
+bool
+deserialize_response(
+  CustomClientInfo * info,
+  CustomClientResponse & response,
+  rmw_request_id_t * request_header,
+  void * ros_response)
+{
+  // Only the bytes of this response, a recycled buffer may hold more from earlier ones
+  eprosima::fastcdr::FastBuffer payload(response.buffer_->getBuffer(), response.length_);
+  eprosima::fastcdr::Cdr deser(
+    payload,
+    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+    eprosima::fastcdr::Cdr::DDS_CDR);
+  bool deserialized = info->response_type_support_->deserializeROSmessage(deser, ros_response);
+
+  request_header->sequence_number = ((int64_t)response.sample_identity_.sequence_number().high) <<
+    32 | response.sample_identity_.sequence_number().low;
+
+  info->listener_->releaseBuffer(response.buffer_);
+  return deserialized;
+}
+}  // namespace
+
 rmw_ret_t
 __rmw_take_response(
   const char * identifier,
@@ -54,16 +81,40 @@ __rmw_take_response(
   CustomClientResponse response;
 
   if (info->listener_->getResponse(response)) {
-    eprosima::fastcdr::Cdr deser(
-      *response.buffer_,
-      eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
-      eprosima::fastcdr::Cdr::DDS_CDR);
-    info->response_type_support_->deserializeROSmessage(deser, ros_response);
+    *taken = deserialize_response(info, response, request_header, ros_response);
+  }
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_take_response_for(
+  const char * identifier,
+  const rmw_client_t * client,
+  int64_t sequence_id,
+  rmw_request_id_t * request_header,
+  void * ros_response,
+  bool * taken)
+{
+  assert(client);
+  assert(request_header);
+  assert(ros_response);
+  assert(taken);
+
+  *taken = false;
 
-    request_header->sequence_number = ((int64_t)response.sample_identity_.sequence_number().high) <<
-      32 | response.sample_identity_.sequence_number().low;
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("client handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  assert(info);
+
+  CustomClientResponse response;
 
-    *taken = true;
+  if (info->listener_->getResponseFor(sequence_id, response)) {
+    *taken = deserialize_response(info, response, request_header, ros_response);
   }
 
   return RMW_RET_OK;
@@ -37,6 +37,8 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "types/custom_wait_set_info.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -68,6 +70,7 @@ __rmw_destroy_service(
       Domain::removePublisher(info->response_publisher_);
     }
     if (info->listener_ != nullptr) {
+      detach_from_wait_sets(info->listener_);
       delete info->listener_;
     }
 
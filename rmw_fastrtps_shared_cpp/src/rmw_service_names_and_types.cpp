@@ -34,6 +34,46 @@
 
 namespace rmw_fastrtps_shared_cpp
 {
+/**
+ * Gather the names and types of all the services known to the participant.
+ *
+ * @param slave_target listener holding the topic caches
+ * @param names_and_types [out] names and types, in the order they are reported
+ */
+static void
+__gather_service_names_and_types(
+  ::ParticipantListener * slave_target,
+  ::ParticipantListener::NamesAndTypes & names_and_types)
+{
+  // Access the slave Listeners, which are the ones that have the topicnamesandtypes member
+  // Get info from publisher and subscriber
+  // Combined results from the two lists
+  std::map<std::string, std::set<std::string>> services;
+
+  // Setup processing function, will be used with two maps
+  auto map_process = [&services](const LockedObject<TopicCache> & topic_cache) {
+      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+      topic_cache().forEachTopicType(
+        [&services](const std::string & topic, const std::string & type, size_t) {
+          std::string service_name = _demangle_service_from_topic(topic);
+          if (service_name.empty()) {
+            // not a service
+            return;
+          }
+          std::string service_type = _demangle_service_type_only(type);
+          if (!service_type.empty()) {
+            services[service_name].insert(service_type);
+          }
+        });
+    };
+
+  map_process(slave_target->reader_topic_cache);
+  map_process(slave_target->writer_topic_cache);
+
+  // The service names and types are demangled already
+  _append_names_and_types(services, false, names_and_types);
+}
+
 rmw_ret_t
 __rmw_get_service_names_and_types(
   const char * identifier,
@@ -62,38 +102,19 @@ __rmw_get_service_names_and_types(
 
   auto impl = static_cast<CustomParticipantInfo *>(node->data);
 
-  // Access the slave Listeners, which are the ones that have the topicnamesandtypes member
-  // Get info from publisher and subscriber
-  // Combined results from the two lists
-  std::map<std::string, std::set<std::string>> services;
-
-  // Setup processing function, will be used with two maps
-  auto map_process = [&services](const LockedObject<TopicCache> & topic_cache) {
-      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
-      for (auto it : topic_cache().getTopicToTypes()) {
-        std::string service_name = _demangle_service_from_topic(it.first);
-        if (service_name.empty()) {
-          // not a service
-          continue;
-        }
-        for (auto & itt : it.second) {
-          std::string service_type = _demangle_service_type_only(itt);
-          if (!service_type.empty()) {
-            services[service_name].insert(service_type);
-          }
-        }
-      }
-    };
-
-  ::ParticipantListener * slave_target = impl->listener;
-  map_process(slave_target->reader_topic_cache);
-  map_process(slave_target->writer_topic_cache);
+  auto slave_target = impl->listener;
+  auto services = slave_target->get_graph_snapshot(
+    ::ParticipantListener::GraphQuery::SERVICES,
+    GUID_t(),
+    [slave_target](::ParticipantListener::NamesAndTypes & names_and_types) {
+      __gather_service_names_and_types(slave_target, names_and_types);
+    });
 
   // Fill out service_names_and_types
-  if (!services.empty()) {
+  if (!services->empty()) {
     // Setup string array to store names
     rmw_ret_t rmw_ret =
-      rmw_names_and_types_init(service_names_and_types, services.size(), allocator);
+      rmw_names_and_types_init(service_names_and_types, services->size(), allocator);
     if (rmw_ret != RMW_RET_OK) {
       return rmw_ret;
     }
@@ -108,7 +129,7 @@ __rmw_get_service_names_and_types(
       };
     // For each service, store the name, initialize the string array for types, and store all types
     size_t index = 0;
-    for (const auto & service_n_types : services) {
+    for (const auto & service_n_types : *services) {
       // Duplicate and store the service_name
       char * service_name = rcutils_strdup(service_n_types.first.c_str(), *allocator);
       if (!service_name) {
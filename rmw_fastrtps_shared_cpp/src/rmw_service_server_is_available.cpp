@@ -12,19 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <string>
-
-#include "fastrtps/subscriber/Subscriber.h"
-
-#include "rcutils/logging_macros.h"
-
 #include "rmw/allocators.h"
 #include "rmw/error_handling.h"
 #include "rmw/impl/cpp/macros.hpp"
 #include "rmw/rmw.h"
 #include "rmw/types.h"
 
-#include "demangle.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
@@ -63,58 +56,9 @@ __rmw_service_server_is_available(
     return RMW_RET_ERROR;
   }
 
-  auto pub_topic_name =
-    client_info->request_publisher_->getAttributes().topic.getTopicName().to_string();
-
-  auto pub_fqdn = _demangle_if_ros_topic(pub_topic_name);
-
-  auto sub_topic_name =
-    client_info->response_subscriber_->getAttributes().topic.getTopicName().to_string();
-
-  auto sub_fqdn = _demangle_if_ros_topic(sub_topic_name);
-
-  *is_available = false;
-  size_t number_of_request_subscribers = 0;
-  rmw_ret_t ret = __rmw_count_subscribers(
-    identifier,
-    node,
-    pub_fqdn.c_str(),
-    &number_of_request_subscribers);
-  if (ret != RMW_RET_OK) {
-    // error string already set
-    return ret;
-  }
-  if (0 == number_of_request_subscribers) {
-    // not ready
-    return RMW_RET_OK;
-  }
-
-  size_t number_of_response_publishers = 0;
-  ret = __rmw_count_publishers(
-    identifier,
-    node,
-    sub_fqdn.c_str(),
-    &number_of_response_publishers);
-  if (ret != RMW_RET_OK) {
-    // error string already set
-    return ret;
-  }
-  if (0 == number_of_response_publishers) {
-    // not ready
-    return RMW_RET_OK;
-  }
-
-  if (0 == client_info->request_publisher_matched_count_.load()) {
-    // not ready
-    return RMW_RET_OK;
-  }
-  if (0 == client_info->response_subscriber_matched_count_.load()) {
-    // not ready
-    return RMW_RET_OK;
-  }
-
-  // all conditions met, there is a service server available
-  *is_available = true;
+  // Kept up to date by the matching callbacks of the client entities. Both
+  // being matched implies the server entities were discovered too.
+  *is_available = client_info->server_available_.load();
   return RMW_RET_OK;
 }
 }  // namespace rmw_fastrtps_shared_cpp
@@ -31,6 +31,8 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "types/custom_wait_set_info.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -70,6 +72,7 @@ __rmw_destroy_subscription(
       Domain::removeSubscriber(info->subscriber_);
     }
     if (info->listener_ != nullptr) {
+      detach_from_wait_sets(info->listener_);
       delete info->listener_;
     }
     if (info->type_support_ != nullptr) {
@@ -26,6 +26,7 @@
 
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/take_sequence.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 namespace rmw_fastrtps_shared_cpp
@@ -147,6 +148,54 @@ __rmw_take_with_info(
   return _take(identifier, subscription, ros_message, taken, message_info, allocation);
 }
 
+rmw_ret_t
+__rmw_take_sequence(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  size_t count,
+  void * const * ros_messages,
+  rmw_message_info_t * message_infos,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation)
+{
+  (void) allocation;
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_messages, "ros_messages pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(taken, "taken count pointer is null", return RMW_RET_ERROR);
+  *taken = 0;
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  eprosima::fastrtps::SampleInfo_t sinfo;
+
+  rmw_fastrtps_shared_cpp::SerializedData data;
+  data.is_cdr_buffer = false;
+  auto take_next = [&](void * ros_message, size_t index, bool & alive) {
+      data.data = ros_message;
+      if (!info->subscriber_->takeNextData(&data, &sinfo)) {
+        return false;
+      }
+      alive = eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind;
+      if (alive && message_infos) {
+        _assign_message_info(identifier, &message_infos[index], &sinfo);
+      }
+      return true;
+    };
+  *taken = take_sequence(
+    count, ros_messages, take_next,
+    [info]() {info->listener_->data_taken(info->subscriber_);});
+
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 _take_serialized_message(
   const char * identifier,
@@ -167,26 +216,23 @@ _take_serialized_message(
   CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
 
-  eprosima::fastcdr::FastBuffer buffer;
   eprosima::fastrtps::SampleInfo_t sinfo;
 
+  // The payload is copied once, from the history straight into serialized_message
   rmw_fastrtps_shared_cpp::SerializedData data;
   data.is_cdr_buffer = true;
-  data.data = &buffer;
-  if (info->subscriber_->takeNextData(&data, &sinfo)) {
+  data.is_serialized_message = true;
+  data.data = serialized_message;
+  bool took = info->subscriber_->takeNextData(&data, &sinfo);
+  if (took || data.serialized_message_ret != RMW_RET_OK) {
     info->listener_->data_taken(info->subscriber_);
-
+  }
+  if (data.serialized_message_ret != RMW_RET_OK) {
+    // The sample did not fit and could not be stored, report it instead of losing it silently
+    return data.serialized_message_ret;  // Error message already set
+  }
+  if (took) {
     if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
-      auto buffer_size = static_cast<size_t>(buffer.getBufferSize());
-      if (serialized_message->buffer_capacity < buffer_size) {
-        auto ret = rmw_serialized_message_resize(serialized_message, buffer_size);
-        if (ret != RMW_RET_OK) {
-          return ret;  // Error message already set
-        }
-      }
-      serialized_message->buffer_length = buffer_size;
-      memcpy(serialized_message->buffer, buffer.getBuffer(), serialized_message->buffer_length);
-
       if (message_info) {
         _assign_message_info(identifier, message_info, &sinfo);
       }
@@ -17,6 +17,7 @@
 #include <string>
 
 #include <functional>
+#include <utility>
 #include <vector>
 
 #include "rcutils/allocator.h"
@@ -42,6 +43,44 @@
 
 namespace rmw_fastrtps_shared_cpp
 {
+/**
+ * Gather the names and types of all the topics known to the participant.
+ *
+ * @param slave_target listener holding the topic caches
+ * @param no_demangle true if demangling will not occur
+ * @param names_and_types [out] names and types, in the order they are reported
+ */
+static void
+__gather_topic_names_and_types(
+  ::ParticipantListener * slave_target,
+  bool no_demangle,
+  ::ParticipantListener::NamesAndTypes & names_and_types)
+{
+  // Access the slave Listeners, which are the ones that have the topicnamesandtypes member
+  // Get info from publisher and subscriber
+  // Combined results from the two lists
+  std::map<std::string, std::set<std::string>> topics;
+
+  // Setup processing function, will be used with two maps
+  auto map_process =
+    [&topics, no_demangle](const LockedObject<TopicCache> & topic_cache) {
+      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+      topic_cache().forEachTopicType(
+        [&topics, no_demangle](const std::string & topic, const std::string & type, size_t) {
+          if (!no_demangle && _get_ros_prefix_if_exists(topic) != ros_topic_prefix) {
+            // if we are demangling and this is not prefixed with rt/, skip it
+            return;
+          }
+          topics[topic].insert(type);
+        });
+    };
+
+  map_process(slave_target->reader_topic_cache);
+  map_process(slave_target->writer_topic_cache);
+
+  _append_names_and_types(topics, !no_demangle, names_and_types);
+}
+
 rmw_ret_t
 __rmw_get_topic_names_and_types(
   const char * identifier,
@@ -72,34 +111,20 @@ __rmw_get_topic_names_and_types(
 
   auto impl = static_cast<CustomParticipantInfo *>(node->data);
 
-  // Access the slave Listeners, which are the ones that have the topicnamesandtypes member
-  // Get info from publisher and subscriber
-  // Combined results from the two lists
-  std::map<std::string, std::set<std::string>> topics;
-
-  // Setup processing function, will be used with two maps
-  auto map_process =
-    [&topics, no_demangle](const LockedObject<TopicCache> & topic_cache) {
-      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
-      for (auto it : topic_cache().getTopicToTypes()) {
-        if (!no_demangle && _get_ros_prefix_if_exists(it.first) != ros_topic_prefix) {
-          // if we are demangling and this is not prefixed with rt/, skip it
-          continue;
-        }
-        for (auto & itt : it.second) {
-          topics[it.first].insert(itt);
-        }
-      }
-    };
-
-  ::ParticipantListener * slave_target = impl->listener;
-  map_process(slave_target->reader_topic_cache);
-  map_process(slave_target->writer_topic_cache);
+  auto slave_target = impl->listener;
+  auto topics = slave_target->get_graph_snapshot(
+    no_demangle ?
+    ::ParticipantListener::GraphQuery::TOPICS_NO_DEMANGLE :
+    ::ParticipantListener::GraphQuery::TOPICS,
+    GUID_t(),
+    [slave_target, no_demangle](::ParticipantListener::NamesAndTypes & names_and_types) {
+      __gather_topic_names_and_types(slave_target, no_demangle, names_and_types);
+    });
 
   // Copy data to results handle
-  if (!topics.empty()) {
+  if (!topics->empty()) {
     // Setup string array to store names
-    rmw_ret_t rmw_ret = rmw_names_and_types_init(topic_names_and_types, topics.size(), allocator);
+    rmw_ret_t rmw_ret = rmw_names_and_types_init(topic_names_and_types, topics->size(), allocator);
     if (rmw_ret != RMW_RET_OK) {
       return rmw_ret;
     }
@@ -112,21 +137,11 @@ __rmw_get_topic_names_and_types(
             "error during report of error: %s", rmw_get_error_string().str);
         }
       };
-    // Setup demangling functions based on no_demangle option
-    auto demangle_topic = _demangle_if_ros_topic;
-    auto demangle_type = _demangle_if_ros_type;
-    if (no_demangle) {
-      auto noop = [](const std::string & in) {
-          return in;
-        };
-      demangle_topic = noop;
-      demangle_type = noop;
-    }
     // For each topic, store the name, initialize the string array for types, and store all types
     size_t index = 0;
-    for (const auto & topic_n_types : topics) {
+    for (const auto & topic_n_types : *topics) {
       // Duplicate and store the topic_name
-      char * topic_name = rcutils_strdup(demangle_topic(topic_n_types.first).c_str(), *allocator);
+      char * topic_name = rcutils_strdup(topic_n_types.first.c_str(), *allocator);
       if (!topic_name) {
         RMW_SET_ERROR_MSG("failed to allocate memory for topic name");
         fail_cleanup();
@@ -148,7 +163,7 @@ __rmw_get_topic_names_and_types(
       // Duplicate and store each type for the topic
       size_t type_index = 0;
       for (const auto & type : topic_n_types.second) {
-        char * type_name = rcutils_strdup(demangle_type(type).c_str(), *allocator);
+        char * type_name = rcutils_strdup(type.c_str(), *allocator);
         if (!type_name) {
           RMW_SET_ERROR_MSG("failed to allocate memory for type name");
           fail_cleanup();
@@ -12,6 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
 #include "fastrtps/subscriber/Subscriber.h"
 
 #include "rmw/error_handling.h"
@@ -24,9 +36,11 @@
 #include "types/custom_wait_set_info.hpp"
 #include "types/guard_condition.hpp"
 
-// helper function for wait
+// helper functions for wait
+static
 bool
-check_wait_set_for_data(
+is_token_ready(
+  size_t token,
   const rmw_subscriptions_t * subscriptions,
   const rmw_guard_conditions_t * guard_conditions,
   const rmw_services_t * services,
@@ -34,58 +48,199 @@ check_wait_set_for_data(
   const rmw_events_t * events)
 {
   if (subscriptions) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      void * data = subscriptions->subscribers[i];
+    if (token < subscriptions->subscriber_count) {
+      void * data = subscriptions->subscribers[token];
       auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
-      // Short circuiting out of this function is possible
-      if (custom_subscriber_info && custom_subscriber_info->listener_->hasData()) {
-        return true;
-      }
+      return custom_subscriber_info->listener_->hasData();
     }
+    token -= subscriptions->subscriber_count;
   }
 
   if (clients) {
-    for (size_t i = 0; i < clients->client_count; ++i) {
-      void * data = clients->clients[i];
+    if (token < clients->client_count) {
+      void * data = clients->clients[token];
       CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
-      if (custom_client_info && custom_client_info->listener_->hasData()) {
-        return true;
-      }
+      return custom_client_info->listener_->hasData();
     }
+    token -= clients->client_count;
   }
 
   if (services) {
-    for (size_t i = 0; i < services->service_count; ++i) {
-      void * data = services->services[i];
+    if (token < services->service_count) {
+      void * data = services->services[token];
       CustomServiceInfo * custom_service_info = static_cast<CustomServiceInfo *>(data);
-      if (custom_service_info && custom_service_info->listener_->hasData()) {
-        return true;
-      }
+      return custom_service_info->listener_->hasData();
     }
+    token -= services->service_count;
   }
 
   if (events) {
-    for (size_t i = 0; i < events->event_count; ++i) {
-      auto event = static_cast<rmw_event_t *>(events->events[i]);
+    if (token < events->event_count) {
+      auto event = static_cast<rmw_event_t *>(events->events[token]);
       auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
-      if (custom_event_info->getListener()->hasEvent(event->event_type)) {
-        return true;
-      }
+      return custom_event_info->getListener()->hasEvent(event->event_type);
     }
+    token -= events->event_count;
   }
 
   if (guard_conditions) {
-    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-      void * data = guard_conditions->guard_conditions[i];
+    if (token < guard_conditions->guard_condition_count) {
+      void * data = guard_conditions->guard_conditions[token];
       auto guard_condition = static_cast<GuardCondition *>(data);
-      if (guard_condition && guard_condition->hasTriggered()) {
-        return true;
-      }
+      return guard_condition->hasTriggered();
     }
   }
   return false;
 }
 
+// Pop every queued token and mark the entities behind it which are still ready.
+static
+size_t
+collect_ready_tokens(
+  CustomWaitsetInfo * wait_set_info,
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  const rmw_events_t * events)
+{
+  size_t ready_count = 0;
+  uint32_t token;
+  while (wait_set_info->ready_queue.pop(token)) {
+    for (uint32_t t = token; t != kNoReadyToken; t = wait_set_info->next_token[t]) {
+      if (!wait_set_info->ready[t] &&
+        is_token_ready(t, subscriptions, guard_conditions, services, clients, events))
+      {
+        wait_set_info->ready[t] = true;
+        wait_set_info->ready_tokens.push_back(t);
+        ++ready_count;
+      }
+    }
+  }
+  return ready_count;
+}
+
+// Mark the entities reported ready by the previous call which still are, e.g.
+// because not all of their data was taken.
+static
+size_t
+collect_carried_tokens(
+  CustomWaitsetInfo * wait_set_info,
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  const rmw_events_t * events)
+{
+  size_t ready_count = 0;
+  for (uint32_t t : wait_set_info->carried_tokens) {
+    if (!wait_set_info->ready[t] &&
+      is_token_ready(t, subscriptions, guard_conditions, services, clients, events))
+    {
+      wait_set_info->ready[t] = true;
+      wait_set_info->ready_tokens.push_back(t);
+      ++ready_count;
+    }
+  }
+  wait_set_info->carried_tokens.clear();
+  return ready_count;
+}
+
+#ifdef __linux__
+// Block in epoll_wait() until the ready queue of the wait set was pushed to or
+// the deadline passed, for wait sets using the eventfd backend.
+static
+void
+wait_for_event_fd(
+  CustomWaitsetInfo * wait_set_info,
+  const std::chrono::steady_clock::time_point * deadline)
+{
+  // Consume pending signals before looking at the queue: a push racing with the
+  // check below writes the eventfd again, so epoll_wait() cannot miss it.
+  uint64_t signals;
+  while (read(wait_set_info->event_fd, &signals, sizeof(signals)) < 0 && errno == EINTR) {
+  }
+  if (!wait_set_info->ready_queue.empty()) {
+    return;
+  }
+
+  int timeout_ms = -1;
+  if (deadline) {
+    auto remaining = *deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::steady_clock::duration::zero()) {
+      return;
+    }
+    // Round up, waking up early would only make the caller wait again.
+    auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      remaining + std::chrono::milliseconds(1) - std::chrono::nanoseconds(1));
+    timeout_ms = static_cast<int>(
+      std::min<std::chrono::milliseconds::rep>(
+        remaining_ms.count(), std::numeric_limits<int>::max()));
+  }
+  // Interruptions and errors return to the caller, which checks the queue and
+  // the deadline again.
+  struct epoll_event event;
+  epoll_wait(wait_set_info->epoll_fd, &event, 1, timeout_ms);
+}
+#endif
+
+template<typename ListenerT>
+static
+void
+detach_listener(void * listener, const ReadyQueue * ready_queue)
+{
+  static_cast<ListenerT *>(listener)->detachCondition(ready_queue);
+}
+
+// Attach a listener with the given token, or chain the token behind the one the
+// listener already got so that a single signal covers all of its entities.
+template<typename ListenerT>
+static
+void
+attach_listener(
+  CustomWaitsetInfo * wait_set_info,
+  ListenerT * listener,
+  const void * key,
+  uint32_t token,
+  bool share_listeners)
+{
+  if (share_listeners) {
+    auto inserted = wait_set_info->listener_tokens.emplace(key, token);
+    if (!inserted.second) {
+      uint32_t head = inserted.first->second;
+      wait_set_info->next_token[token] = wait_set_info->next_token[head];
+      wait_set_info->next_token[head] = token;
+      return;
+    }
+  }
+  listener->attachCondition(
+    &wait_set_info->condition_mutex, &wait_set_info->condition,
+    &wait_set_info->ready_queue, token);
+  wait_set_info->attachments.push_back({key, listener, &detach_listener<ListenerT>});
+}
+
+// Append the handles of an entity array to the attached ones, or compare them
+// against the attached ones starting at `offset`.
+static
+void
+record_handles(std::vector<const void *> & handles, void * const * array, size_t count)
+{
+  handles.insert(handles.end(), array, array + count);
+}
+
+static
+bool
+match_handles(
+  const std::vector<const void *> & handles, size_t & offset,
+  void * const * array, size_t count)
+{
+  if (count > 0 && !std::equal(array, array + count, handles.begin() + offset)) {
+    return false;
+  }
+  offset += count;
+  return true;
+}
+
 namespace rmw_fastrtps_shared_cpp
 {
 rmw_ret_t
@@ -118,134 +273,236 @@ __rmw_wait(
     return RMW_RET_ERROR;
   }
 
-  if (subscriptions) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      void * data = subscriptions->subscribers[i];
-      auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
-      custom_subscriber_info->listener_->attachCondition(conditionMutex, conditionVariable);
-    }
+  const std::array<size_t, 5> counts = {{
+    subscriptions ? subscriptions->subscriber_count : 0,
+    clients ? clients->client_count : 0,
+    services ? services->service_count : 0,
+    events ? events->event_count : 0,
+    guard_conditions ? guard_conditions->guard_condition_count : 0
+  }};
+  size_t token_count = 0;
+  for (size_t count : counts) {
+    token_count += count;
   }
-
-  if (clients) {
-    for (size_t i = 0; i < clients->client_count; ++i) {
-      void * data = clients->clients[i];
-      CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
-      custom_client_info->listener_->attachCondition(conditionMutex, conditionVariable);
-    }
+  if (token_count >= kNoReadyToken) {
+    RMW_SET_ERROR_MSG("too many entities in wait set");
+    return RMW_RET_ERROR;
   }
 
-  if (services) {
-    for (size_t i = 0; i < services->service_count; ++i) {
-      void * data = services->services[i];
-      auto custom_service_info = static_cast<CustomServiceInfo *>(data);
-      custom_service_info->listener_->attachCondition(conditionMutex, conditionVariable);
-    }
-  }
+  ReadyQueue * readyQueue = &wait_set_info->ready_queue;
+  {
+    std::lock_guard<std::mutex> lock(wait_set_info->attachments_mutex);
+    wait_set_info->in_use = true;
 
-  if (events) {
-    for (size_t i = 0; i < events->event_count; ++i) {
-      auto event = static_cast<rmw_event_t *>(events->events[i]);
-      auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
-      custom_event_info->getListener()->attachCondition(conditionMutex, conditionVariable);
+    // The attached handles are the fingerprint of the wait set. Comparing them
+    // touches no listener, and unlike a hash it cannot miss a change.
+    bool attached = false;
+    if (wait_set_info->persistent_attachments &&
+      !readyQueue->invalidated() &&
+      wait_set_info->attached_counts == counts)
+    {
+      const std::vector<const void *> & handles = wait_set_info->attached_handles;
+      size_t offset = 0;
+      attached =
+        (!subscriptions ||
+        match_handles(handles, offset, subscriptions->subscribers, counts[0])) &&
+        (!clients || match_handles(handles, offset, clients->clients, counts[1])) &&
+        (!services || match_handles(handles, offset, services->services, counts[2])) &&
+        (!events || match_handles(handles, offset, events->events, counts[3])) &&
+        (!guard_conditions ||
+        match_handles(handles, offset, guard_conditions->guard_conditions, counts[4]));
     }
-  }
 
-  if (guard_conditions) {
-    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-      void * data = guard_conditions->guard_conditions[i];
-      auto guard_condition = static_cast<GuardCondition *>(data);
-      guard_condition->attachCondition(conditionMutex, conditionVariable);
+    if (!attached) {
+      detach_wait_set_listeners(wait_set_info);
+
+      // Nothing is attached at this point, so nobody can push while resetting.
+      readyQueue->reset(static_cast<uint32_t>(token_count));
+      wait_set_info->next_token.assign(token_count, kNoReadyToken);
+      wait_set_info->ready.assign(token_count, false);
+      wait_set_info->ready_tokens.clear();
+      wait_set_info->carried_tokens.clear();
+      wait_set_info->listener_tokens.clear();
+
+      // Only events can share a listener with another entity of the wait set.
+      const bool share_listeners = events && events->event_count > 0;
+
+      // Attaching a listener which already has data queues its token right
+      // away, so the wait below never has to look at entities which did not
+      // signal.
+      uint32_t token = 0;
+      if (subscriptions) {
+        for (size_t i = 0; i < subscriptions->subscriber_count; ++i, ++token) {
+          void * data = subscriptions->subscribers[i];
+          auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
+          SubListener * listener = custom_subscriber_info->listener_;
+          attach_listener(wait_set_info, listener, listener, token, share_listeners);
+        }
+        record_handles(
+          wait_set_info->attached_handles, subscriptions->subscribers, counts[0]);
+      }
+
+      if (clients) {
+        for (size_t i = 0; i < clients->client_count; ++i, ++token) {
+          void * data = clients->clients[i];
+          CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
+          ClientListener * listener = custom_client_info->listener_;
+          attach_listener(wait_set_info, listener, listener, token, false);
+        }
+        record_handles(wait_set_info->attached_handles, clients->clients, counts[1]);
+      }
+
+      if (services) {
+        for (size_t i = 0; i < services->service_count; ++i, ++token) {
+          void * data = services->services[i];
+          auto custom_service_info = static_cast<CustomServiceInfo *>(data);
+          ServiceListener * listener = custom_service_info->listener_;
+          attach_listener(wait_set_info, listener, listener, token, false);
+        }
+        record_handles(wait_set_info->attached_handles, services->services, counts[2]);
+      }
+
+      if (events) {
+        for (size_t i = 0; i < events->event_count; ++i, ++token) {
+          auto event = static_cast<rmw_event_t *>(events->events[i]);
+          auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
+          EventListenerInterface * listener = custom_event_info->getListener();
+          attach_listener(
+            wait_set_info, listener, dynamic_cast<const void *>(listener), token,
+            share_listeners);
+        }
+        record_handles(wait_set_info->attached_handles, events->events, counts[3]);
+      }
+
+      if (guard_conditions) {
+        for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i, ++token) {
+          void * data = guard_conditions->guard_conditions[i];
+          auto guard_condition = static_cast<GuardCondition *>(data);
+          attach_listener(wait_set_info, guard_condition, guard_condition, token, false);
+        }
+        record_handles(
+          wait_set_info->attached_handles, guard_conditions->guard_conditions, counts[4]);
+      }
+      wait_set_info->attached_counts = counts;
     }
   }
 
-  // This mutex prevents any of the listeners
-  // to change the internal state and notify the condition
-  // between the call to hasData() / hasTriggered() and wait()
-  // otherwise the decision to wait might be incorrect
-  std::unique_lock<std::mutex> lock(*conditionMutex);
-
-  bool hasData = check_wait_set_for_data(
-    subscriptions, guard_conditions, services, clients, events);
-  auto predicate = [subscriptions, guard_conditions, services, clients, events]() {
-      return check_wait_set_for_data(subscriptions, guard_conditions, services, clients, events);
+  // The predicate only looks at the ready queue, so spurious wakeups and
+  // re-checks cost the same regardless of how many entities are attached.
+  // Listeners push while holding conditionMutex, which keeps the decision to
+  // wait consistent with their notifications.
+  auto predicate = [readyQueue]() {
+      return !readyQueue->empty();
     };
 
-  bool timeout = false;
-  if (!hasData) {
-    if (!wait_timeout) {
-      conditionVariable->wait(lock, predicate);
-    } else if (wait_timeout->sec > 0 || wait_timeout->nsec > 0) {
-      auto n = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::seconds(wait_timeout->sec));
-      n += std::chrono::nanoseconds(wait_timeout->nsec);
-      timeout = !conditionVariable->wait_for(lock, n, predicate);
-    } else {
-      timeout = true;
-    }
+  std::chrono::steady_clock::time_point deadline;
+  if (wait_timeout) {
+    deadline = std::chrono::steady_clock::now() +
+      std::chrono::seconds(wait_timeout->sec) +
+      std::chrono::nanoseconds(wait_timeout->nsec);
   }
 
-  // Unlock the condition variable mutex to prevent deadlocks that can occur if
-  // a listener triggers while the condition variable is being detached.
-  // Listeners will no longer be prevented from changing their internal state,
-  // but that should not cause issues (if a listener has data / has triggered
-  // after we check, it will be caught on the next call to this function).
-  lock.unlock();
+  // Entities still ready since the previous call did not signal again, they
+  // are checked directly and the wait below is skipped if any is.
+  size_t ready_count = collect_carried_tokens(
+    wait_set_info, subscriptions, guard_conditions, services, clients, events);
+  for (;;) {
+    if (ready_count == 0) {
+#ifdef __linux__
+      if (wait_set_info->event_fd >= 0) {
+        wait_for_event_fd(wait_set_info, wait_timeout ? &deadline : nullptr);
+      } else
+#endif
+      {
+        std::unique_lock<std::mutex> lock(*conditionMutex);
+        if (!wait_timeout) {
+          conditionVariable->wait(lock, predicate);
+        } else {
+          conditionVariable->wait_until(lock, deadline, predicate);
+        }
+      }
+    }
+    // Tokens are consumed outside of conditionMutex, listeners keep pushing
+    // concurrently. A token whose entity lost its data in the meantime, e.g.
+    // because it was taken from another thread, does not end the wait.
+    ready_count += collect_ready_tokens(
+      wait_set_info, subscriptions, guard_conditions, services, clients, events);
+    if (ready_count > 0 ||
+      (wait_timeout && std::chrono::steady_clock::now() >= deadline))
+    {
+      break;
+    }
+  }
 
+  // Clear the entities which are not ready. An entity becoming ready after its
+  // token was collected still has its token queued, or queues it again when
+  // attached by the next call.
+  const std::vector<bool> & ready = wait_set_info->ready;
+  uint32_t token = 0;
   if (subscriptions) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      void * data = subscriptions->subscribers[i];
-      auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
-      custom_subscriber_info->listener_->detachCondition();
-      if (!custom_subscriber_info->listener_->hasData()) {
+    for (size_t i = 0; i < subscriptions->subscriber_count; ++i, ++token) {
+      if (!ready[token]) {
         subscriptions->subscribers[i] = 0;
       }
     }
   }
 
   if (clients) {
-    for (size_t i = 0; i < clients->client_count; ++i) {
-      void * data = clients->clients[i];
-      CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
-      custom_client_info->listener_->detachCondition();
-      if (!custom_client_info->listener_->hasData()) {
+    for (size_t i = 0; i < clients->client_count; ++i, ++token) {
+      if (!ready[token]) {
         clients->clients[i] = 0;
       }
     }
   }
 
   if (services) {
-    for (size_t i = 0; i < services->service_count; ++i) {
-      void * data = services->services[i];
-      auto custom_service_info = static_cast<CustomServiceInfo *>(data);
-      custom_service_info->listener_->detachCondition();
-      if (!custom_service_info->listener_->hasData()) {
+    for (size_t i = 0; i < services->service_count; ++i, ++token) {
+      if (!ready[token]) {
         services->services[i] = 0;
       }
     }
   }
 
   if (events) {
-    for (size_t i = 0; i < events->event_count; ++i) {
-      auto event = static_cast<rmw_event_t *>(events->events[i]);
-      auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
-      custom_event_info->getListener()->detachCondition();
-      if (!custom_event_info->getListener()->hasEvent(event->event_type)) {
+    for (size_t i = 0; i < events->event_count; ++i, ++token) {
+      if (!ready[token]) {
         events->events[i] = nullptr;
       }
     }
   }
 
   if (guard_conditions) {
-    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
+    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i, ++token) {
       void * data = guard_conditions->guard_conditions[i];
       auto guard_condition = static_cast<GuardCondition *>(data);
-      guard_condition->detachCondition();
-      if (!guard_condition->getHasTriggered()) {
+      if (!ready[token] || !guard_condition->getHasTriggered()) {
         guard_conditions->guard_conditions[i] = 0;
       }
     }
   }
 
-  return timeout ? RMW_RET_TIMEOUT : RMW_RET_OK;
+  {
+    std::lock_guard<std::mutex> lock(wait_set_info->attachments_mutex);
+    if (!wait_set_info->persistent_attachments) {
+      detach_wait_set_listeners(wait_set_info);
+    }
+    wait_set_info->in_use = false;
+  }
+
+  // Entities reported ready may still be ready on the next call, e.g. when not
+  // all of their data is taken. They signaled already, so the next call checks
+  // them again instead of rescanning everything. They are not queued again: that
+  // would write the eventfd, waking an external event loop even when all of
+  // their data gets taken. Guard conditions reported ready were reset above.
+  const size_t guard_conditions_begin = token_count - counts[4];
+  for (uint32_t ready_token : wait_set_info->ready_tokens) {
+    wait_set_info->ready[ready_token] = false;
+    if (wait_set_info->persistent_attachments && ready_token < guard_conditions_begin) {
+      wait_set_info->carried_tokens.push_back(ready_token);
+    }
+  }
+  wait_set_info->ready_tokens.clear();
+
+  return ready_count > 0 ? RMW_RET_OK : RMW_RET_TIMEOUT;
 }
 }  // namespace rmw_fastrtps_shared_cpp
@@ -12,6 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "rcutils/logging_macros.h"
+
 #include "rmw/allocators.h"
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
@@ -21,8 +35,103 @@
 
 #include "types/custom_wait_set_info.hpp"
 
+static
+bool
+is_env_flag_set(const char * env_var)
+{
+  bool value = false;
+  char * config_env_val = nullptr;
+#ifndef _WIN32
+  config_env_val = getenv(env_var);
+  if (config_env_val != nullptr) {
+    value = strcmp(config_env_val, "1") == 0;
+  }
+#else
+  size_t config_env_val_size;
+  _dupenv_s(&config_env_val, &config_env_val_size, env_var);
+  if (config_env_val != nullptr) {
+    value = strcmp(config_env_val, "1") == 0;
+  }
+  free(config_env_val);
+#endif
+  return value;
+}
+
+#ifdef __linux__
+static
+bool
+open_event_fds(CustomWaitsetInfo * wait_set_info)
+{
+  wait_set_info->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wait_set_info->event_fd < 0) {
+    RMW_SET_ERROR_MSG("failed to create wait set eventfd");
+    return false;
+  }
+  wait_set_info->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (wait_set_info->epoll_fd < 0) {
+    RMW_SET_ERROR_MSG("failed to create wait set epoll instance");
+    return false;
+  }
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = wait_set_info->event_fd;
+  if (epoll_ctl(wait_set_info->epoll_fd, EPOLL_CTL_ADD, wait_set_info->event_fd, &event) != 0) {
+    RMW_SET_ERROR_MSG("failed to add eventfd to wait set epoll instance");
+    return false;
+  }
+  wait_set_info->ready_queue.set_event_fd(wait_set_info->event_fd);
+  return true;
+}
+#endif
+
+static
+void
+close_event_fds(CustomWaitsetInfo * wait_set_info)
+{
+#ifdef __linux__
+  wait_set_info->ready_queue.set_event_fd(-1);
+  if (wait_set_info->epoll_fd >= 0) {
+    close(wait_set_info->epoll_fd);
+    wait_set_info->epoll_fd = -1;
+  }
+  if (wait_set_info->event_fd >= 0) {
+    close(wait_set_info->event_fd);
+    wait_set_info->event_fd = -1;
+  }
+#else
+  (void)wait_set_info;
+#endif
+}
+
 namespace rmw_fastrtps_shared_cpp
 {
+// Wait sets which may hold on to listeners between rmw_wait() calls.
+static std::mutex wait_sets_mutex;
+static std::unordered_set<CustomWaitsetInfo *> wait_sets;
+
+void
+detach_from_wait_sets(const void * listener)
+{
+  std::lock_guard<std::mutex> lock(wait_sets_mutex);
+  for (CustomWaitsetInfo * wait_set_info : wait_sets) {
+    std::lock_guard<std::mutex> attachments_lock(wait_set_info->attachments_mutex);
+    // A wait set in use only has the entities of the ongoing rmw_wait() attached,
+    // and those must not be destroyed while it runs.
+    if (wait_set_info->in_use) {
+      continue;
+    }
+    const auto & attachments = wait_set_info->attachments;
+    auto it = std::find_if(
+      attachments.begin(), attachments.end(),
+      [listener](const WaitSetAttachment & attachment) {
+        return attachment.key == listener;
+      });
+    if (it != attachments.end()) {
+      detach_wait_set_listeners(wait_set_info);
+    }
+  }
+}
+
 rmw_wait_set_t *
 __rmw_create_wait_set(const char * identifier, rmw_context_t * context, size_t max_conditions)
 {
@@ -54,11 +163,40 @@ __rmw_create_wait_set(const char * identifier, rmw_context_t * context, size_t m
     goto fail;
   }
 
+  // Check if keeping listeners attached across rmw_wait() calls has been
+  // enabled from the RMW_FASTRTPS_PERSISTENT_WAIT_SET env variable.
+  wait_set_info->persistent_attachments = is_env_flag_set("RMW_FASTRTPS_PERSISTENT_WAIT_SET");
+
+  // Check if the eventfd backend, which lets the wait set be polled from an
+  // external event loop, has been enabled from the RMW_FASTRTPS_WAIT_SET_EVENTFD
+  // env variable. The eventfd is only signaled by attached listeners, so it
+  // implies keeping them attached.
+  if (is_env_flag_set("RMW_FASTRTPS_WAIT_SET_EVENTFD")) {
+#ifdef __linux__
+    if (!open_event_fds(wait_set_info)) {
+      goto fail;
+    }
+    wait_set_info->persistent_attachments = true;
+#else
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "RMW_FASTRTPS_WAIT_SET_EVENTFD is only supported on Linux, ignoring it");
+#endif
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(wait_sets_mutex);
+    wait_sets.insert(wait_set_info);
+  }
+
   return wait_set;
 
 fail:
   if (wait_set) {
     if (wait_set->data) {
+      if (wait_set_info) {
+        close_event_fds(wait_set_info);
+      }
       RMW_TRY_DESTRUCTOR_FROM_WITHIN_FAILURE(
         wait_set_info->~CustomWaitsetInfo(), wait_set_info)
       rmw_free(wait_set->data);
@@ -92,6 +230,14 @@ __rmw_destroy_wait_set(const char * identifier, rmw_wait_set_t * wait_set)
     return RMW_RET_ERROR;
   }
 
+  {
+    std::lock_guard<std::mutex> lock(wait_sets_mutex);
+    wait_sets.erase(wait_set_info);
+    std::lock_guard<std::mutex> attachments_lock(wait_set_info->attachments_mutex);
+    detach_wait_set_listeners(wait_set_info);
+  }
+  close_event_fds(wait_set_info);
+
   if (wait_set->data) {
     if (wait_set_info) {
       RMW_TRY_DESTRUCTOR(
@@ -102,4 +248,32 @@ __rmw_destroy_wait_set(const char * identifier, rmw_wait_set_t * wait_set)
   rmw_wait_set_free(wait_set);
   return result;
 }
+
+rmw_ret_t
+__rmw_get_wait_set_event_fd(
+  const char * identifier,
+  const rmw_wait_set_t * wait_set,
+  int * fd)
+{
+  if (!wait_set) {
+    RMW_SET_ERROR_MSG("wait set handle is null");
+    return RMW_RET_ERROR;
+  }
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    wait set handle,
+    wait_set->implementation_identifier, identifier,
+    return RMW_RET_ERROR)
+  if (!fd) {
+    RMW_SET_ERROR_MSG("fd is null");
+    return RMW_RET_ERROR;
+  }
+
+  auto wait_set_info = static_cast<CustomWaitsetInfo *>(wait_set->data);
+  if (!wait_set_info) {
+    RMW_SET_ERROR_MSG("wait set info is null");
+    return RMW_RET_ERROR;
+  }
+  *fd = wait_set_info->event_fd;
+  return RMW_RET_OK;
+}
 }  // namespace rmw_fastrtps_shared_cpp
@@ -15,13 +15,103 @@
 #ifndef TYPES__CUSTOM_WAIT_SET_INFO_HPP_
 #define TYPES__CUSTOM_WAIT_SET_INFO_HPP_
 
+#include <array>
 #include <condition_variable>
+#include <cstdint>
+#include <limits>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rmw_fastrtps_shared_cpp/ready_queue.hpp"
+
+/// Marks the end of a chain in CustomWaitsetInfo::next_token.
+constexpr uint32_t kNoReadyToken = std::numeric_limits<uint32_t>::max();
+
+/// A listener attached to a wait set, kept to detach it later on.
+struct WaitSetAttachment
+{
+  /// Address of the most derived listener object, to find it on destruction.
+  const void * key;
+  void * listener;
+  void (* detach)(void * listener, const ReadyQueue * ready_queue);
+};
 
 typedef struct CustomWaitsetInfo
 {
   std::condition_variable condition;
   std::mutex condition_mutex;
+
+  /// Tokens of the attached entities which became ready.
+  /**
+   * Tokens are handed out in the order of the arrays given to rmw_wait():
+   * subscriptions, clients, services, events and then guard conditions.
+   */
+  ReadyQueue ready_queue;
+  /// Next token served by the same listener, e.g. a subscription and its events.
+  std::vector<uint32_t> next_token;
+  /// Whether the entity of a token was found ready by the current rmw_wait().
+  std::vector<bool> ready;
+  /// Tokens found ready by the current rmw_wait().
+  std::vector<uint32_t> ready_tokens;
+  /// Tokens reported ready by the previous rmw_wait(), checked again by the next one.
+  /**
+   * They are not queued again, so the eventfd is only written when an entity signals.
+   */
+  std::vector<uint32_t> carried_tokens;
+  /// First token given to each listener, only used to share listeners with events.
+  std::unordered_map<const void *, uint32_t> listener_tokens;
+
+  /// Keep listeners attached across rmw_wait() calls while the entities do not change.
+  bool persistent_attachments = false;
+
+  /// eventfd written by ready_queue, -1 unless the eventfd backend is enabled.
+  /**
+   * rmw_wait() then blocks in epoll_wait() on epoll_fd instead of on condition.
+   */
+  int event_fd = -1;
+  int epoll_fd = -1;
+
+  /// Protects the attachments against entities being destroyed concurrently.
+  std::mutex attachments_mutex;
+  /// Set while rmw_wait() runs, its attachments are then the entities in use.
+  bool in_use RCPPUTILS_TSA_GUARDED_BY(attachments_mutex) = false;
+  /// Entity counts of the attached arrays, in token order.
+  std::array<size_t, 5> attached_counts RCPPUTILS_TSA_GUARDED_BY(attachments_mutex) {};
+  /// Handles of the attached entities, in token order.
+  std::vector<const void *> attached_handles RCPPUTILS_TSA_GUARDED_BY(attachments_mutex);
+  std::vector<WaitSetAttachment> attachments RCPPUTILS_TSA_GUARDED_BY(attachments_mutex);
 } CustomWaitsetInfo;
 
+/// Detach every listener attached to the wait set and forget about them.
+inline
+void
+detach_wait_set_listeners(CustomWaitsetInfo * wait_set_info)
+RCPPUTILS_TSA_REQUIRES(wait_set_info->attachments_mutex)
+{
+  for (const WaitSetAttachment & attachment : wait_set_info->attachments) {
+    attachment.detach(attachment.listener, &wait_set_info->ready_queue);
+  }
+  wait_set_info->attachments.clear();
+  wait_set_info->attached_handles.clear();
+  wait_set_info->attached_counts.fill(0);
+}
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Detach the listeners of every idle wait set which has `listener` attached.
+/**
+ * Has to be called before destroying a listener which may have been given to
+ * rmw_wait(), so that wait sets keeping their attachments do not touch it later.
+ *
+ * \param listener Address of the most derived listener object.
+ */
+void
+detach_from_wait_sets(const void * listener);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
 #endif  // TYPES__CUSTOM_WAIT_SET_INFO_HPP_
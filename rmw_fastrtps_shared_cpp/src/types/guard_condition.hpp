@@ -24,16 +24,24 @@
 
 #include "rcpputils/thread_safety_annotations.hpp"
 
+#include "rmw_fastrtps_shared_cpp/ready_queue.hpp"
+
 class GuardCondition
 {
 public:
   GuardCondition()
   : hasTriggered_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr) {}
+    conditionMutex_(nullptr), conditionVariable_(nullptr),
+    readyQueue_(nullptr), readyToken_(0) {}
 
   void
   trigger()
   {
+    // Not taken since the previous trigger: the waiter has yet to wake up or to
+    // report this guard condition, either way it sees the changes made until now.
+    if (hasTriggered_) {
+      return;
+    }
     std::lock_guard<std::mutex> lock(internalMutex_);
 
     if (conditionMutex_ != nullptr) {
@@ -42,6 +50,9 @@ public:
       // rmw_wait() which checks hasTriggered() and decides if wait() needs to
       // be called
       hasTriggered_ = true;
+      if (readyQueue_ != nullptr) {
+        readyQueue_->push(readyToken_);
+      }
       clock.unlock();
       conditionVariable_->notify_one();
     } else {
@@ -50,19 +61,36 @@ public:
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    ReadyQueue * readyQueue,
+    uint32_t readyToken)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != nullptr && readyQueue_ != readyQueue) {
+      // Another wait set takes this listener over, the previous one has to reattach
+      readyQueue_->invalidate();
+    }
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyQueue_ = readyQueue;
+    readyToken_ = readyToken;
+    if (readyQueue_ != nullptr && hasTriggered_) {
+      readyQueue_->push(readyToken_);
+    }
   }
 
   void
-  detachCondition()
+  detachCondition(const ReadyQueue * readyQueue)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    if (readyQueue_ != readyQueue) {
+      return;
+    }
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyQueue_ = nullptr;
   }
 
   bool
@@ -82,6 +110,8 @@ private:
   std::atomic_bool hasTriggered_;
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  ReadyQueue * readyQueue_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  uint32_t readyToken_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
 };
 
 #endif  // TYPES__GUARD_CONDITION_HPP_
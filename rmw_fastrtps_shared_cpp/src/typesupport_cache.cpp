@@ -0,0 +1,55 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/typesupport_cache.hpp"
+
+#include <utility>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+TypeSupportCache::TypeSupportCache()
+{
+}
+
+TypeSupportCache::~TypeSupportCache()
+{
+}
+
+TypeSupport *
+TypeSupportCache::get(const rosidl_message_type_support_t * type_support, const Factory & create)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = typesupports_.find(type_support);
+  if (it != typesupports_.end()) {
+    return it->second.get();
+  }
+  // Created while holding the lock, so that each type is only built once.
+  std::unique_ptr<TypeSupport> typesupport(create());
+  if (!typesupport) {
+    return nullptr;
+  }
+  TypeSupport * ret = typesupport.get();
+  typesupports_.emplace(type_support, std::move(typesupport));
+  return ret;
+}
+
+size_t
+TypeSupportCache::size()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return typesupports_.size();
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
@@ -0,0 +1,40 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FAKE_TYPE_SUPPORT_HPP_
+#define FAKE_TYPE_SUPPORT_HPP_
+
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+
+// Type support of an empty message, for tests that only exercise the shared machinery
+class FakeTypeSupport : public rmw_fastrtps_shared_cpp::TypeSupport
+{
+public:
+  size_t getEstimatedSerializedSize(const void *) override
+  {
+    return 0;
+  }
+
+  bool serializeROSmessage(const void *, eprosima::fastcdr::Cdr &) override
+  {
+    return true;
+  }
+
+  bool deserializeROSmessage(eprosima::fastcdr::Cdr &, void *) override
+  {
+    return true;
+  }
+};
+
+#endif  // FAKE_TYPE_SUPPORT_HPP_
@@ -0,0 +1,98 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/bounded_queue.hpp"
+
+using rmw_fastrtps_shared_cpp::BoundedQueue;
+
+TEST(BoundedQueueTest, test_push_pop_in_order) {
+  BoundedQueue<int> queue(4);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_TRUE(queue.push(2));
+  EXPECT_EQ(queue.size(), 2u);
+
+  int value = 0;
+  ASSERT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 1);
+  ASSERT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 2);
+  EXPECT_FALSE(queue.pop(value));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(BoundedQueueTest, test_full) {
+  BoundedQueue<int> queue(3);
+  ASSERT_EQ(queue.capacity(), 4u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.push(i));
+  }
+  EXPECT_FALSE(queue.push(4));
+
+  int value = 0;
+  ASSERT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 0);
+  // Room was made for one more element.
+  EXPECT_TRUE(queue.push(4));
+  EXPECT_FALSE(queue.push(5));
+}
+
+TEST(BoundedQueueTest, test_concurrent_producers_and_consumers) {
+  BoundedQueue<int> queue(64);
+  const int per_producer = 10000;
+  const int producers = 4;
+  const int consumers = 4;
+  std::atomic<long long> sum(0);
+  std::atomic<int> popped(0);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back(
+      [&queue, p, per_producer]() {
+        for (int i = 1; i <= per_producer; ++i) {
+          while (!queue.push(p * per_producer + i)) {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+  for (int c = 0; c < consumers; ++c) {
+    threads.emplace_back(
+      [&]() {
+        int value = 0;
+        while (popped.load() < producers * per_producer) {
+          if (queue.pop(value)) {
+            sum += value;
+            ++popped;
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  const long long total = static_cast<long long>(producers) * per_producer;
+  EXPECT_EQ(popped.load(), total);
+  EXPECT_EQ(sum.load(), total * (total + 1) / 2);
+  EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,63 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+
+using eprosima::fastrtps::rtps::GUID_t;
+using DiscoveredNodes = ParticipantListener::DiscoveredNodes;
+
+static GUID_t
+make_guid(unsigned char value)
+{
+  GUID_t guid;
+  guid.guidPrefix.value[0] = value;
+  return guid;
+}
+
+TEST(DiscoveredNodesTest, test_lowest_guid_wins) {
+  DiscoveredNodes nodes;
+  const auto name = std::make_pair(std::string("/ns"), std::string("talker"));
+  nodes.add(make_guid(5), DiscoveredNodes::Node{"talker", "/ns"});
+  nodes.add(make_guid(3), DiscoveredNodes::Node{"talker", "/ns"});
+  nodes.add(make_guid(7), DiscoveredNodes::Node{"talker", "/ns"});
+  nodes.add(make_guid(1), DiscoveredNodes::Node{"listener", "/ns"});
+  ASSERT_EQ(nodes.guids_by_name.size(), 2u);
+  EXPECT_EQ(nodes.guids_by_name.at(name).guid, make_guid(3));
+  EXPECT_EQ(nodes.guids_by_name.at(name).count, 3u);
+
+  // Removing the indexed node falls back on the next lowest GUID with the same name
+  nodes.remove(make_guid(3));
+  EXPECT_EQ(nodes.guids_by_name.at(name).guid, make_guid(5));
+  nodes.remove(make_guid(7));
+  EXPECT_EQ(nodes.guids_by_name.at(name).guid, make_guid(5));
+  EXPECT_EQ(nodes.guids_by_name.at(name).count, 1u);
+}
+
+TEST(DiscoveredNodesTest, test_remove_last_node_with_name) {
+  DiscoveredNodes nodes;
+  nodes.add(make_guid(2), DiscoveredNodes::Node{"talker", "/"});
+  nodes.add(make_guid(4), DiscoveredNodes::Node{"listener", "/"});
+  nodes.remove(make_guid(9));
+  EXPECT_EQ(nodes.nodes.size(), 2u);
+
+  nodes.remove(make_guid(2));
+  EXPECT_EQ(nodes.nodes.size(), 1u);
+  ASSERT_EQ(nodes.guids_by_name.size(), 1u);
+  EXPECT_EQ(nodes.guids_by_name.count(std::make_pair(std::string("/"), std::string("talker"))), 0u);
+}
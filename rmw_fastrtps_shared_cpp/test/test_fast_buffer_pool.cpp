@@ -0,0 +1,57 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "fastcdr/FastBuffer.h"
+
+#include "rmw_fastrtps_shared_cpp/fast_buffer_pool.hpp"
+
+using eprosima::fastcdr::FastBuffer;
+using rmw_fastrtps_shared_cpp::FastBufferPool;
+
+TEST(FastBufferPoolTest, test_released_buffer_is_reused) {
+  FastBufferPool pool(2);
+  FastBuffer * buffer = pool.acquire();
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(pool.misses(), 1u);
+  ASSERT_TRUE(buffer->resize(100));
+  size_t size = buffer->getBufferSize();
+  pool.release(buffer);
+  EXPECT_EQ(pool.typical_size(), size);
+
+  FastBuffer * reused = pool.acquire();
+  EXPECT_EQ(reused, buffer);
+  EXPECT_EQ(reused->getBufferSize(), size);
+  EXPECT_EQ(pool.hits(), 1u);
+  pool.release(reused);
+}
+
+TEST(FastBufferPoolTest, test_oversized_buffer_is_not_kept) {
+  FastBufferPool pool(4);
+  FastBuffer * buffer = pool.acquire();
+  FastBuffer * large = pool.acquire();
+  ASSERT_TRUE(buffer->resize(100));
+  ASSERT_TRUE(large->resize(1000000));
+  pool.release(buffer);
+  pool.release(large);
+
+  // Only the buffer of the usual size was kept
+  EXPECT_EQ(pool.acquire(), buffer);
+  FastBuffer * fresh = pool.acquire();
+  EXPECT_EQ(pool.misses(), 3u);
+  EXPECT_EQ(fresh->getBufferSize(), 0u);
+  pool.release(buffer);
+  pool.release(fresh);
+}
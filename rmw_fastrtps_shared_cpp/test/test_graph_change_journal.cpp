@@ -0,0 +1,77 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/graph_change_journal.hpp"
+
+using eprosima::fastrtps::rtps::GUID_t;
+using rmw_fastrtps_shared_cpp::GraphChange;
+using rmw_fastrtps_shared_cpp::GraphChangeJournal;
+
+static const auto chatter = std::make_shared<const std::string>("rt/chatter");
+static const auto string_type = std::make_shared<const std::string>("String");
+
+TEST(GraphChangeJournalTest, test_changes_since_sequence) {
+  GraphChangeJournal journal(4);
+  std::vector<GraphChange> changes;
+  EXPECT_EQ(journal.lastSequence(), 0u);
+  EXPECT_TRUE(journal.getChangesSince(0, changes));
+  EXPECT_TRUE(changes.empty());
+
+  EXPECT_EQ(journal.record(true, true, GUID_t(), chatter, string_type), 1u);
+  EXPECT_EQ(journal.record(true, false, GUID_t(), chatter, string_type), 2u);
+  EXPECT_EQ(journal.record(false, true, GUID_t(), chatter, string_type), 3u);
+  EXPECT_EQ(journal.lastSequence(), 3u);
+
+  ASSERT_TRUE(journal.getChangesSince(1, changes));
+  ASSERT_EQ(changes.size(), 2u);
+  EXPECT_EQ(changes[0].sequence, 2u);
+  EXPECT_TRUE(changes[0].is_alive);
+  EXPECT_FALSE(changes[0].is_reader);
+  EXPECT_EQ(changes[1].sequence, 3u);
+  EXPECT_FALSE(changes[1].is_alive);
+  EXPECT_TRUE(changes[1].is_reader);
+  // The names are shared, not copied
+  EXPECT_EQ(changes[1].topic_name, chatter);
+  EXPECT_EQ(changes[1].type_name, string_type);
+  EXPECT_EQ(*changes[1].topic_name, "rt/chatter");
+
+  changes.clear();
+  EXPECT_TRUE(journal.getChangesSince(3, changes));
+  EXPECT_TRUE(changes.empty());
+  // A sequence which was never reached cannot be resumed from
+  EXPECT_FALSE(journal.getChangesSince(4, changes));
+}
+
+TEST(GraphChangeJournalTest, test_dropped_changes_need_resync) {
+  GraphChangeJournal journal(2);
+  for (int i = 0; i < 5; ++i) {
+    journal.record(true, true, GUID_t(), chatter, string_type);
+  }
+  std::vector<GraphChange> changes;
+  // Changes 1 to 3 were dropped
+  EXPECT_FALSE(journal.getChangesSince(0, changes));
+  EXPECT_FALSE(journal.getChangesSince(2, changes));
+  EXPECT_TRUE(changes.empty());
+
+  ASSERT_TRUE(journal.getChangesSince(3, changes));
+  ASSERT_EQ(changes.size(), 2u);
+  EXPECT_EQ(changes[0].sequence, 4u);
+  EXPECT_EQ(changes[1].sequence, 5u);
+}
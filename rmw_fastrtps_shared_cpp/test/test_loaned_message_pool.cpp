@@ -0,0 +1,87 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
+
+using rmw_fastrtps_shared_cpp::LoanedMessagePool;
+
+namespace
+{
+struct Message
+{
+  uint64_t value;
+  double other;
+};
+}  // namespace
+
+TEST(LoanedMessagePoolTest, test_borrow_and_give_back) {
+  int inits = 0;
+  int finis = 0;
+  LoanedMessagePool pool(
+    sizeof(Message),
+    [&inits](void * message) {
+      static_cast<Message *>(message)->value = 42;
+      ++inits;
+    },
+    [&finis](void *) {++finis;});
+  EXPECT_EQ(pool.message_size(), sizeof(Message));
+
+  void * message = pool.borrow();
+  ASSERT_NE(message, nullptr);
+  EXPECT_EQ(inits, 1);
+  EXPECT_EQ(static_cast<Message *>(message)->value, 42u);
+  EXPECT_TRUE(pool.is_lent(message));
+
+  EXPECT_TRUE(pool.give_back(message));
+  EXPECT_EQ(finis, 1);
+  EXPECT_FALSE(pool.is_lent(message));
+  // A message can only be given back once
+  EXPECT_FALSE(pool.give_back(message));
+  EXPECT_EQ(finis, 1);
+}
+
+TEST(LoanedMessagePoolTest, test_slots_are_reused) {
+  LoanedMessagePool pool(sizeof(Message), nullptr, nullptr, 1);
+  void * first = pool.borrow();
+  void * second = pool.borrow();
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(first, second);
+  EXPECT_TRUE(pool.is_lent(first));
+  EXPECT_TRUE(pool.is_lent(second));
+
+  EXPECT_TRUE(pool.give_back(first));
+  EXPECT_EQ(pool.borrow(), first);
+  EXPECT_TRUE(pool.give_back(second));
+  EXPECT_TRUE(pool.give_back(first));
+}
+
+TEST(LoanedMessagePoolTest, test_foreign_messages_are_rejected) {
+  LoanedMessagePool pool(sizeof(Message), nullptr, nullptr);
+  LoanedMessagePool other_pool(sizeof(Message), nullptr, nullptr);
+  Message local;
+  void * foreign = other_pool.borrow();
+  ASSERT_NE(foreign, nullptr);
+
+  EXPECT_FALSE(pool.is_lent(&local));
+  EXPECT_FALSE(pool.give_back(&local));
+  EXPECT_FALSE(pool.is_lent(foreign));
+  EXPECT_FALSE(pool.give_back(foreign));
+  EXPECT_TRUE(other_pool.is_lent(foreign));
+  EXPECT_FALSE(pool.give_back(nullptr));
+}
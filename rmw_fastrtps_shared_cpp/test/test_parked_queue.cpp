@@ -0,0 +1,100 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/parked_queue.hpp"
+
+using rmw_fastrtps_shared_cpp::ParkedQueue;
+
+TEST(ParkedQueueTest, test_take_by_key) {
+  ParkedQueue<std::string> parked;
+  EXPECT_TRUE(parked.park(3, "three"));
+  EXPECT_TRUE(parked.park(1, "one"));
+  EXPECT_TRUE(parked.park(2, "two"));
+  EXPECT_EQ(parked.size(), 3u);
+
+  std::string value;
+  ASSERT_TRUE(parked.take(2, value));
+  EXPECT_EQ(value, "two");
+  EXPECT_FALSE(parked.take(2, value));
+  EXPECT_FALSE(parked.take(4, value));
+  ASSERT_TRUE(parked.take(3, value));
+  EXPECT_EQ(value, "three");
+  EXPECT_EQ(parked.size(), 1u);
+}
+
+TEST(ParkedQueueTest, test_take_oldest_in_arrival_order) {
+  ParkedQueue<std::string> parked;
+  parked.park(3, "three");
+  parked.park(1, "one");
+  parked.park(2, "two");
+  parked.park(5, "five");
+
+  std::string value;
+  ASSERT_TRUE(parked.take(1, value));
+  // The value taken by key is skipped
+  ASSERT_TRUE(parked.takeOldest(value));
+  EXPECT_EQ(value, "three");
+  ASSERT_TRUE(parked.takeOldest(value));
+  EXPECT_EQ(value, "two");
+  ASSERT_TRUE(parked.takeOldest(value));
+  EXPECT_EQ(value, "five");
+  EXPECT_FALSE(parked.takeOldest(value));
+  EXPECT_EQ(parked.size(), 0u);
+  EXPECT_EQ(parked.orderSize(), 0u);
+}
+
+TEST(ParkedQueueTest, test_duplicate_key_is_not_parked) {
+  ParkedQueue<std::string> parked;
+  EXPECT_TRUE(parked.park(1, "first"));
+  EXPECT_FALSE(parked.park(1, "duplicate"));
+  EXPECT_EQ(parked.size(), 1u);
+  EXPECT_EQ(parked.orderSize(), 1u);
+
+  std::string value;
+  ASSERT_TRUE(parked.take(1, value));
+  EXPECT_EQ(value, "first");
+}
+
+TEST(ParkedQueueTest, test_order_is_compacted) {
+  ParkedQueue<int> parked(16);
+  for (int64_t key = 0; key < 16; ++key) {
+    ASSERT_TRUE(parked.park(key, static_cast<int>(key)));
+  }
+  EXPECT_EQ(parked.orderSize(), 16u);
+
+  // Take the even keys, newest first, so that the oldest keys stay in the order
+  int value = 0;
+  for (int64_t key = 14; key >= 0; key -= 2) {
+    ASSERT_TRUE(parked.take(key, value));
+    EXPECT_EQ(value, key);
+    EXPECT_LE(parked.orderSize(), 2 * parked.size());
+  }
+  EXPECT_EQ(parked.size(), 8u);
+  EXPECT_EQ(parked.orderSize(), 16u);
+
+  // Taking one more makes the taken keys the majority
+  ASSERT_TRUE(parked.take(15, value));
+  EXPECT_EQ(parked.size(), 7u);
+  EXPECT_EQ(parked.orderSize(), 7u);
+
+  // The arrival order of the remaining values is kept
+  for (int expected = 1; expected < 15; expected += 2) {
+    ASSERT_TRUE(parked.takeOldest(value));
+    EXPECT_EQ(value, expected);
+  }
+  EXPECT_FALSE(parked.takeOldest(value));
+}
@@ -0,0 +1,190 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw/init.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+
+using eprosima::fastrtps::rtps::GUID_t;
+using eprosima::fastrtps::rtps::InstanceHandle_t;
+using GraphQuery = ParticipantListener::GraphQuery;
+using NamesAndTypes = ParticipantListener::NamesAndTypes;
+
+namespace
+{
+const char * const kIdentifier = "test_participant_listener";
+
+// What process_discovery_info() reads of the proxy data of a discovered endpoint
+struct FakeProxyData
+{
+  const InstanceHandle_t & RTPSParticipantKey() const
+  {
+    return key;
+  }
+
+  const std::string & topicName() const
+  {
+    return topic;
+  }
+
+  const std::string & typeName() const
+  {
+    return type;
+  }
+
+  InstanceHandle_t key;
+  std::string topic;
+  std::string type;
+};
+
+FakeProxyData
+make_reader(unsigned char participant, const std::string & topic)
+{
+  FakeProxyData reader{InstanceHandle_t(), topic, "std_msgs::msg::dds_::String_"};
+  reader.key.value[0] = participant;
+  return reader;
+}
+
+class ParticipantListenerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    context = rmw_get_zero_initialized_context();
+    context.implementation_identifier = kIdentifier;
+    wait_set = rmw_fastrtps_shared_cpp::__rmw_create_wait_set(kIdentifier, &context, 1);
+    ASSERT_NE(wait_set, nullptr);
+    graph_guard_condition = rmw_fastrtps_shared_cpp::__rmw_create_guard_condition(kIdentifier);
+    ASSERT_NE(graph_guard_condition, nullptr);
+  }
+
+  void TearDown() override
+  {
+    // Only once the listeners are gone, like rmw_destroy_node() does
+    EXPECT_EQ(
+      rmw_fastrtps_shared_cpp::__rmw_destroy_guard_condition(graph_guard_condition), RMW_RET_OK);
+    EXPECT_EQ(
+      rmw_fastrtps_shared_cpp::__rmw_destroy_wait_set(kIdentifier, wait_set), RMW_RET_OK);
+  }
+
+  // Wait for the graph guard condition to be triggered, and take the trigger.
+  bool
+  wait_for_trigger(std::chrono::milliseconds timeout)
+  {
+    void * conditions[] = {graph_guard_condition->data};
+    rmw_guard_conditions_t guard_conditions{1, conditions};
+    rmw_time_t wait_timeout{
+      static_cast<uint64_t>(timeout.count() / 1000),
+      static_cast<uint64_t>(timeout.count() % 1000) * 1000000};
+    rmw_ret_t ret = rmw_fastrtps_shared_cpp::__rmw_wait(
+      nullptr, &guard_conditions, nullptr, nullptr, nullptr, wait_set, &wait_timeout);
+    return RMW_RET_OK == ret && conditions[0] != nullptr;
+  }
+
+  rmw_context_t context;
+  rmw_wait_set_t * wait_set = nullptr;
+  rmw_guard_condition_t * graph_guard_condition = nullptr;
+};
+}  // namespace
+
+TEST_F(ParticipantListenerTest, test_graph_snapshot_reused_until_change) {
+  ParticipantListener listener(graph_guard_condition);
+  size_t builds = 0;
+  auto build = [&listener, &builds](NamesAndTypes & names_and_types) {
+      ++builds;
+      auto & topic_cache = listener.reader_topic_cache;
+      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+      topic_cache().forEachTopicType(
+        [&names_and_types](const std::string & topic, const std::string & type, size_t) {
+          names_and_types.emplace_back(topic, std::vector<std::string>{type});
+        });
+    };
+
+  auto first = listener.get_graph_snapshot(GraphQuery::TOPICS, GUID_t(), build);
+  EXPECT_TRUE(first->empty());
+  EXPECT_EQ(listener.get_graph_snapshot(GraphQuery::TOPICS, GUID_t(), build), first);
+  EXPECT_EQ(builds, 1u);
+  // Each query has a snapshot of its own
+  listener.get_graph_snapshot(GraphQuery::SERVICES, GUID_t(), build);
+  EXPECT_EQ(builds, 2u);
+
+  FakeProxyData reader = make_reader(1, "rt/chatter");
+  uint64_t generation = listener.graph_generation();
+  listener.process_discovery_info(reader, true, true);
+  EXPECT_EQ(listener.graph_generation(), generation + 1);
+  auto second = listener.get_graph_snapshot(GraphQuery::TOPICS, GUID_t(), build);
+  EXPECT_EQ(builds, 3u);
+  ASSERT_EQ(second->size(), 1u);
+  EXPECT_EQ(second->front().first, "rt/chatter");
+  // The previous snapshot is left as it was for whoever still holds it
+  EXPECT_TRUE(first->empty());
+  EXPECT_EQ(listener.get_graph_snapshot(GraphQuery::TOPICS, GUID_t(), build), second);
+  EXPECT_EQ(builds, 3u);
+
+  listener.process_discovery_info(reader, false, true);
+  auto third = listener.get_graph_snapshot(GraphQuery::TOPICS, GUID_t(), build);
+  EXPECT_EQ(builds, 4u);
+  EXPECT_TRUE(third->empty());
+}
+
+TEST_F(ParticipantListenerTest, test_graph_changes_notified_once_per_window) {
+  const std::chrono::milliseconds window(300);
+  ParticipantListener listener(graph_guard_condition, window);
+
+  // The first change of a burst is notified right away
+  FakeProxyData first = make_reader(1, "rt/topic_0");
+  auto start = std::chrono::steady_clock::now();
+  listener.process_discovery_info(first, true, true);
+  ASSERT_TRUE(wait_for_trigger(std::chrono::seconds(10)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, window);
+
+  // The next ones are notified together, once the window ends
+  for (unsigned char i = 1; i < 10; ++i) {
+    FakeProxyData reader = make_reader(i, "rt/topic_" + std::to_string(i));
+    listener.process_discovery_info(reader, true, true);
+  }
+  EXPECT_FALSE(wait_for_trigger(std::chrono::milliseconds(0)));
+  EXPECT_TRUE(wait_for_trigger(std::chrono::seconds(10)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, window);
+
+  // Nothing is left to notify
+  EXPECT_FALSE(wait_for_trigger(2 * window));
+}
+
+TEST_F(ParticipantListenerTest, test_destroyed_while_notifier_waits) {
+  // Far longer than the test may take
+  std::unique_ptr<ParticipantListener> listener(
+    new ParticipantListener(graph_guard_condition, std::chrono::hours(1)));
+  FakeProxyData reader = make_reader(1, "rt/chatter");
+  listener->process_discovery_info(reader, true, true);
+  ASSERT_TRUE(wait_for_trigger(std::chrono::seconds(10)));
+
+  // Pending until the end of the window, which the destructor does not wait for
+  listener->process_discovery_info(reader, false, true);
+  auto start = std::chrono::steady_clock::now();
+  listener.reset();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+
+  // The pending change is dropped with the listener, so its guard condition can be destroyed
+  EXPECT_FALSE(wait_for_trigger(std::chrono::milliseconds(100)));
+}
@@ -0,0 +1,101 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/ready_queue.hpp"
+
+TEST(ReadyQueueTest, test_push_pop_in_order) {
+  ReadyQueue queue;
+  queue.reset(3);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.push(2));
+  EXPECT_TRUE(queue.push(0));
+  EXPECT_FALSE(queue.empty());
+
+  uint32_t token;
+  ASSERT_TRUE(queue.pop(token));
+  EXPECT_EQ(token, 2u);
+  ASSERT_TRUE(queue.pop(token));
+  EXPECT_EQ(token, 0u);
+  EXPECT_FALSE(queue.pop(token));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ReadyQueueTest, test_token_queued_once) {
+  ReadyQueue queue;
+  queue.reset(1);
+  EXPECT_TRUE(queue.push(0));
+  EXPECT_FALSE(queue.push(0));
+
+  uint32_t token;
+  ASSERT_TRUE(queue.pop(token));
+  EXPECT_FALSE(queue.pop(token));
+  // Once consumed, the token can be queued again.
+  EXPECT_TRUE(queue.push(0));
+}
+
+TEST(ReadyQueueTest, test_out_of_range_token) {
+  ReadyQueue queue;
+  queue.reset(2);
+  EXPECT_FALSE(queue.push(2));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ReadyQueueTest, test_reset_drops_tokens) {
+  ReadyQueue queue;
+  queue.reset(4);
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_TRUE(queue.push(3));
+  queue.reset(8);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.push(7));
+  EXPECT_TRUE(queue.push(1));
+  uint32_t token;
+  ASSERT_TRUE(queue.pop(token));
+  EXPECT_EQ(token, 7u);
+}
+
+TEST(ReadyQueueTest, test_concurrent_producers) {
+  const uint32_t tokens_per_thread = 1000;
+  const uint32_t thread_count = 4;
+  ReadyQueue queue;
+  queue.reset(tokens_per_thread * thread_count);
+
+  std::vector<std::thread> producers;
+  for (uint32_t t = 0; t < thread_count; ++t) {
+    producers.emplace_back(
+      [&queue, t, tokens_per_thread]() {
+        for (uint32_t i = 0; i < tokens_per_thread; ++i) {
+          queue.push(t * tokens_per_thread + i);
+        }
+      });
+  }
+
+  std::set<uint32_t> seen;
+  uint32_t token;
+  while (seen.size() < tokens_per_thread * thread_count) {
+    if (queue.pop(token)) {
+      EXPECT_TRUE(seen.insert(token).second);
+    }
+  }
+  for (auto & producer : producers) {
+    producer.join();
+  }
+  EXPECT_FALSE(queue.pop(token));
+}
@@ -0,0 +1,113 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <deque>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/take_sequence.hpp"
+
+using rmw_fastrtps_shared_cpp::take_sequence;
+
+namespace
+{
+
+/// Samples waiting in a subscription, as (value, alive) pairs.
+class FakeSamples
+{
+public:
+  explicit FakeSamples(std::deque<std::pair<int, bool>> samples)
+  : data_taken_calls(0), samples_(std::move(samples))
+  {}
+
+  bool
+  take_next(void * ros_message, size_t index, bool & alive)
+  {
+    (void) index;
+    if (samples_.empty()) {
+      return false;
+    }
+    *static_cast<int *>(ros_message) = samples_.front().first;
+    alive = samples_.front().second;
+    samples_.pop_front();
+    return true;
+  }
+
+  size_t
+  take(size_t count, void * const * ros_messages)
+  {
+    return take_sequence(
+      count, ros_messages,
+      [this](void * ros_message, size_t index, bool & alive) {
+        return take_next(ros_message, index, alive);
+      },
+      [this]() {++data_taken_calls;});
+  }
+
+  size_t
+  left() const
+  {
+    return samples_.size();
+  }
+
+  size_t data_taken_calls;
+
+private:
+  std::deque<std::pair<int, bool>> samples_;
+};
+
+}  // namespace
+
+TEST(TakeSequenceTest, test_takes_several_samples_and_refreshes_once) {
+  FakeSamples samples({{1, true}, {2, true}, {3, true}, {4, true}});
+  int messages[3] = {0, 0, 0};
+  void * ros_messages[3] = {&messages[0], &messages[1], &messages[2]};
+
+  EXPECT_EQ(samples.take(3, ros_messages), 3u);
+  EXPECT_EQ(messages[0], 1);
+  EXPECT_EQ(messages[1], 2);
+  EXPECT_EQ(messages[2], 3);
+  EXPECT_EQ(samples.data_taken_calls, 1u);
+  EXPECT_EQ(samples.left(), 1u);
+
+  EXPECT_EQ(samples.take(3, ros_messages), 1u);
+  EXPECT_EQ(messages[0], 4);
+  EXPECT_EQ(samples.data_taken_calls, 2u);
+}
+
+TEST(TakeSequenceTest, test_samples_not_alive_are_not_counted) {
+  FakeSamples samples({{1, true}, {-1, false}, {2, true}, {-1, false}});
+  int messages[3] = {0, 0, 0};
+  void * ros_messages[3] = {&messages[0], &messages[1], &messages[2]};
+
+  EXPECT_EQ(samples.take(3, ros_messages), 2u);
+  EXPECT_EQ(messages[0], 1);
+  EXPECT_EQ(messages[1], 2);
+  EXPECT_EQ(samples.data_taken_calls, 1u);
+  EXPECT_EQ(samples.left(), 0u);
+}
+
+TEST(TakeSequenceTest, test_nothing_taken_does_not_refresh) {
+  FakeSamples samples({});
+  int message = 0;
+  void * ros_messages[1] = {&message};
+
+  EXPECT_EQ(samples.take(1, ros_messages), 0u);
+  EXPECT_EQ(samples.data_taken_calls, 0u);
+
+  FakeSamples one({{1, true}});
+  EXPECT_EQ(one.take(0, ros_messages), 0u);
+  EXPECT_EQ(one.data_taken_calls, 0u);
+  EXPECT_EQ(one.left(), 1u);
+}
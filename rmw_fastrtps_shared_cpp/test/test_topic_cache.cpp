@@ -0,0 +1,165 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/topic_cache.hpp"
+
+using eprosima::fastrtps::rtps::InstanceHandle_t;
+
+namespace
+{
+InstanceHandle_t
+participant_key(unsigned char id)
+{
+  InstanceHandle_t key;
+  key.value[0] = id;
+  return key;
+}
+
+std::map<std::pair<std::string, std::string>, size_t>
+topic_types_of(const TopicCache & cache)
+{
+  std::map<std::pair<std::string, std::string>, size_t> result;
+  cache.forEachTopicType(
+    [&result](const std::string & topic, const std::string & type, size_t count) {
+      result[{topic, type}] = count;
+    });
+  return result;
+}
+}  // namespace
+
+TEST(TopicCacheTest, test_add_and_remove_count_endpoints) {
+  TopicCache cache;
+  auto first = participant_key(1);
+  auto second = participant_key(2);
+
+  EXPECT_TRUE(cache.addTopic(first, "rt/chatter", "String"));
+  EXPECT_TRUE(cache.addTopic(first, "rt/chatter", "String"));
+  EXPECT_TRUE(cache.addTopic(second, "rt/chatter", "Log"));
+  EXPECT_EQ(cache.getTopicCount("rt/chatter"), 3u);
+  EXPECT_EQ(cache.getTopicCount("rt/other"), 0u);
+
+  auto topic_types = topic_types_of(cache);
+  ASSERT_EQ(topic_types.size(), 2u);
+  EXPECT_EQ((topic_types[{"rt/chatter", "String"}]), 2u);
+  EXPECT_EQ((topic_types[{"rt/chatter", "Log"}]), 1u);
+
+  EXPECT_TRUE(cache.removeTopic(first, "rt/chatter", "String"));
+  EXPECT_TRUE(cache.removeTopic(second, "rt/chatter", "Log"));
+  EXPECT_EQ(cache.getTopicCount("rt/chatter"), 1u);
+  topic_types = topic_types_of(cache);
+  ASSERT_EQ(topic_types.size(), 1u);
+  EXPECT_EQ((topic_types[{"rt/chatter", "String"}]), 1u);
+
+  EXPECT_TRUE(cache.removeTopic(first, "rt/chatter", "String"));
+  EXPECT_EQ(cache.getTopicCount("rt/chatter"), 0u);
+  EXPECT_TRUE(topic_types_of(cache).empty());
+}
+
+TEST(TopicCacheTest, test_unexpected_removal_is_ignored) {
+  TopicCache cache;
+  auto key = participant_key(1);
+  EXPECT_FALSE(cache.removeTopic(key, "rt/chatter", "String"));
+  EXPECT_TRUE(cache.addTopic(key, "rt/chatter", "String"));
+  EXPECT_FALSE(cache.removeTopic(key, "rt/chatter", "Log"));
+  EXPECT_EQ(cache.getTopicCount("rt/chatter"), 1u);
+}
+
+TEST(TopicCacheTest, test_topics_per_participant) {
+  TopicCache cache;
+  auto first = participant_key(1);
+  auto second = participant_key(2);
+  auto first_guid = iHandle2GUID(first);
+  auto second_guid = iHandle2GUID(second);
+  cache.addTopic(first, "rt/chatter", "String");
+  cache.addTopic(second, "rt/scan", "LaserScan");
+
+  std::map<std::string, std::string> topics;
+  auto collect = [&topics](const std::string & topic, const std::string & type, size_t) {
+      topics[topic] = type;
+    };
+  EXPECT_TRUE(cache.forEachTopicTypeOf(first_guid, collect));
+  ASSERT_EQ(topics.size(), 1u);
+  EXPECT_EQ(topics["rt/chatter"], "String");
+
+  cache.removeTopic(second, "rt/scan", "LaserScan");
+  EXPECT_FALSE(cache.forEachTopicTypeOf(second_guid, collect));
+  size_t participants = 0;
+  cache.forEachParticipant([&participants](const GUID_t &) {++participants;});
+  EXPECT_EQ(participants, 1u);
+
+  // Names forgotten with their last endpoint can be used again
+  cache.addTopic(second, "rt/scan", "LaserScan");
+  EXPECT_EQ(cache.getTopicCount("rt/scan"), 1u);
+  EXPECT_EQ(cache.getTopicCount("rt/chatter"), 1u);
+}
+
+TEST(TopicCacheTest, test_ros_topic_count) {
+  TopicCache cache;
+  auto key = participant_key(1);
+  cache.addTopic(key, "rt/chatter", "String");
+  cache.addTopic(key, "rq/chatter", "String");
+  cache.addTopic(key, "/chatter", "String");
+  cache.addTopic(key, "chatter", "String");
+  cache.addTopic(key, "rt/chatter_other", "String");
+  EXPECT_EQ(cache.getRosTopicCount("/chatter"), 3u);
+  EXPECT_EQ(cache.getRosTopicCount("/chatter_other"), 1u);
+  EXPECT_EQ(cache.getRosTopicCount("chatter"), 0u);
+  EXPECT_EQ(cache.getTopicCount("rt/chatter"), 1u);
+
+  cache.removeTopic(key, "rt/chatter", "String");
+  cache.removeTopic(key, "/chatter", "String");
+  EXPECT_EQ(cache.getRosTopicCount("/chatter"), 1u);
+  cache.removeTopic(key, "rq/chatter", "String");
+  EXPECT_EQ(cache.getRosTopicCount("/chatter"), 0u);
+}
+
+TEST(TopicCacheTest, test_shared_names) {
+  TopicCache cache;
+  auto first = participant_key(1);
+  auto second = participant_key(2);
+  TopicCache::SharedName topic;
+  TopicCache::SharedName type;
+  EXPECT_TRUE(cache.addTopic(first, "rt/chatter", "String", &topic, &type));
+  ASSERT_TRUE(topic && type);
+  EXPECT_EQ(*topic, "rt/chatter");
+  EXPECT_EQ(*type, "String");
+
+  // The names are interned, not copied per endpoint
+  TopicCache::SharedName other_topic;
+  TopicCache::SharedName other_type;
+  EXPECT_TRUE(cache.addTopic(second, "rt/chatter", "String", &other_topic, &other_type));
+  EXPECT_EQ(other_topic, topic);
+  EXPECT_EQ(other_type, type);
+  EXPECT_TRUE(cache.forEachSharedTopicTypeOf(iHandle2GUID(second),
+    [&](const TopicCache::SharedName & shared_topic, const TopicCache::SharedName & shared_type,
+    size_t count) {
+      EXPECT_EQ(shared_topic, topic);
+      EXPECT_EQ(shared_type, type);
+      EXPECT_EQ(count, 1u);
+    }));
+
+  // The names outlive the removal of their last endpoint
+  EXPECT_TRUE(cache.removeTopic(first, "rt/chatter", "String"));
+  EXPECT_TRUE(cache.removeTopic(second, "rt/chatter", "String", &other_topic, &other_type));
+  EXPECT_EQ(other_topic, topic);
+  EXPECT_EQ(*other_topic, "rt/chatter");
+  EXPECT_EQ(*other_type, "String");
+  EXPECT_EQ(cache.getTopicCount("rt/chatter"), 0u);
+}
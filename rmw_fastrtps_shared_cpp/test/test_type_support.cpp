@@ -0,0 +1,146 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "fastcdr/FastBuffer.h"
+
+#include "rcutils/allocator.h"
+#include "rmw/error_handling.h"
+#include "rmw/serialized_message.h"
+
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+
+#include "./fake_type_support.hpp"
+
+using rmw_fastrtps_shared_cpp::SerializedData;
+using rmw_fastrtps_shared_cpp::TypeSupport;
+
+namespace
+{
+// Payload of a sample much smaller than the buffers Fast-CDR grows by default
+class SmallPayload
+{
+public:
+  SmallPayload()
+  : payload(12)
+  {
+    const char bytes[] = {0, 1, 0, 0, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 0};
+    memcpy(payload.data, bytes, sizeof(bytes));
+    payload.length = sizeof(bytes);
+  }
+
+  // Owns its data, freed on destruction
+  eprosima::fastrtps::rtps::SerializedPayload_t payload;
+};
+
+void *
+failing_reallocate(void *, size_t, void *)
+{
+  return nullptr;
+}
+}  // namespace
+
+TEST(TypeSupportTest, test_taken_serialized_message_keeps_its_length) {
+  FakeTypeSupport type_support;
+  SmallPayload sample;
+
+  for (size_t capacity : {0u, 4u, 256u}) {
+    rmw_serialized_message_t message = rmw_get_zero_initialized_serialized_message();
+    rcutils_allocator_t allocator = rcutils_get_default_allocator();
+    ASSERT_EQ(rmw_serialized_message_init(&message, capacity, &allocator), RMW_RET_OK);
+
+    SerializedData data;
+    data.is_cdr_buffer = true;
+    data.is_serialized_message = true;
+    data.data = &message;
+    ASSERT_TRUE(type_support.deserialize(&sample.payload, &data));
+    EXPECT_EQ(message.buffer_length, sample.payload.length);
+    EXPECT_GE(message.buffer_capacity, sample.payload.length);
+    EXPECT_EQ(0, memcmp(message.buffer, sample.payload.data, sample.payload.length));
+
+    EXPECT_EQ(rmw_serialized_message_fini(&message), RMW_RET_OK);
+  }
+}
+
+TEST(TypeSupportTest, test_taken_serialized_message_reports_resize_error) {
+  FakeTypeSupport type_support;
+  SmallPayload sample;
+
+  rmw_serialized_message_t message = rmw_get_zero_initialized_serialized_message();
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  ASSERT_EQ(rmw_serialized_message_init(&message, 4, &allocator), RMW_RET_OK);
+  message.allocator.reallocate = failing_reallocate;
+
+  SerializedData data;
+  data.is_cdr_buffer = true;
+  data.is_serialized_message = true;
+  data.data = &message;
+  EXPECT_FALSE(type_support.deserialize(&sample.payload, &data));
+  EXPECT_NE(data.serialized_message_ret, RMW_RET_OK);
+  rmw_reset_error();
+
+  message.allocator = allocator;
+  EXPECT_EQ(rmw_serialized_message_fini(&message), RMW_RET_OK);
+}
+
+TEST(TypeSupportTest, test_taken_into_fresh_buffer_keeps_its_length) {
+  FakeTypeSupport type_support;
+  SmallPayload sample;
+
+  eprosima::fastcdr::FastBuffer buffer;
+  SerializedData data;
+  data.is_cdr_buffer = true;
+  data.data = &buffer;
+  ASSERT_TRUE(type_support.deserialize(&sample.payload, &data));
+  EXPECT_EQ(buffer.getBufferSize(), sample.payload.length);
+  EXPECT_EQ(data.length, sample.payload.length);
+  EXPECT_EQ(0, memcmp(buffer.getBuffer(), sample.payload.data, sample.payload.length));
+}
+
+TEST(TypeSupportTest, test_taken_into_recycled_buffer) {
+  FakeTypeSupport type_support;
+  SmallPayload sample;
+
+  eprosima::fastcdr::FastBuffer large;
+  ASSERT_TRUE(large.reserve(64));
+  char * storage = large.getBuffer();
+  SerializedData data;
+  data.is_cdr_buffer = true;
+  data.data = &large;
+
+  // A longer sample first, whose bytes are left over past the next one
+  eprosima::fastrtps::rtps::SerializedPayload_t longer(40);
+  memset(longer.data, 'x', 40);
+  longer.length = 40;
+  ASSERT_TRUE(type_support.deserialize(&longer, &data));
+  EXPECT_EQ(data.length, 40u);
+
+  ASSERT_TRUE(type_support.deserialize(&sample.payload, &data));
+  EXPECT_EQ(large.getBuffer(), storage);
+  EXPECT_EQ(large.getBufferSize(), 64u);
+  // Only the length of the sample is to be deserialized, not the whole buffer
+  EXPECT_EQ(data.length, sample.payload.length);
+  EXPECT_EQ(0, memcmp(large.getBuffer(), sample.payload.data, sample.payload.length));
+
+  eprosima::fastcdr::FastBuffer small;
+  ASSERT_TRUE(small.reserve(4));
+  data.data = &small;
+  ASSERT_TRUE(type_support.deserialize(&sample.payload, &data));
+  EXPECT_GE(small.getBufferSize(), sample.payload.length);
+  EXPECT_EQ(data.length, sample.payload.length);
+  EXPECT_EQ(0, memcmp(small.getBuffer(), sample.payload.data, sample.payload.length));
+}
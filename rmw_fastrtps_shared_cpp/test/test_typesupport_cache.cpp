@@ -0,0 +1,84 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/typesupport_cache.hpp"
+
+#include "./fake_type_support.hpp"
+
+using rmw_fastrtps_shared_cpp::TypeSupport;
+using rmw_fastrtps_shared_cpp::TypeSupportCache;
+
+TEST(TypeSupportCacheTest, test_created_once_per_type) {
+  TypeSupportCache cache;
+  rosidl_message_type_support_t first {};
+  rosidl_message_type_support_t second {};
+  int created = 0;
+  auto create = [&created]() -> TypeSupport * {
+      ++created;
+      return new FakeTypeSupport();
+    };
+
+  TypeSupport * tss = cache.get(&first, create);
+  ASSERT_NE(tss, nullptr);
+  EXPECT_EQ(cache.get(&first, create), tss);
+  EXPECT_EQ(created, 1);
+
+  TypeSupport * other = cache.get(&second, create);
+  ASSERT_NE(other, nullptr);
+  EXPECT_NE(other, tss);
+  EXPECT_EQ(created, 2);
+  EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST(TypeSupportCacheTest, test_failed_creation_not_cached) {
+  TypeSupportCache cache;
+  rosidl_message_type_support_t type_support {};
+  EXPECT_EQ(cache.get(&type_support, []() -> TypeSupport * {return nullptr;}), nullptr);
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_NE(cache.get(&type_support, []() -> TypeSupport * {return new FakeTypeSupport();}),
+    nullptr);
+}
+
+TEST(TypeSupportCacheTest, test_concurrent_get) {
+  TypeSupportCache cache;
+  rosidl_message_type_support_t type_support {};
+  std::atomic<int> created(0);
+  std::vector<TypeSupport *> results(8, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back(
+      [&, i]() {
+        for (int j = 0; j < 1000; ++j) {
+          results[i] = cache.get(
+            &type_support, [&created]() -> TypeSupport * {
+              ++created;
+              return new FakeTypeSupport();
+            });
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(created.load(), 1);
+  for (TypeSupport * result : results) {
+    EXPECT_EQ(result, results[0]);
+  }
+}